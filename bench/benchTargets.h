@@ -0,0 +1,103 @@
+#ifndef BENCHTARGETS_H
+#define BENCHTARGETS_H
+//------------------------------------------------------------------------------
+// Targets for the kinematics benchmarks.
+//
+// Generated in the tracker frame (cm, z = 0 at the soil) inside the
+// governor's cartesian limits (config/governor.yaml), then rotated with the
+// same deltaFrame.h code the governor uses.
+//------------------------------------------------------------------------------
+
+#include "deltaFrame.h"
+
+// google benchmark
+#include <benchmark/benchmark.h>
+
+// STD
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// config/governor.yaml
+static const float benchLimitXMin = -32, benchLimitXMax = 32;
+static const float benchLimitYMin = -40, benchLimitYMax = 25;
+static const float benchWorkspaceHeight = 12;
+static const float benchSoilOffset = 3.0f;
+static const float benchToolOffset = -9.0f;
+
+enum BenchDistribution {
+  BENCH_GRID,   // every point of a 2 cm grid over the workspace
+  BENCH_FIELD,  // weeds as we see them on our beds, state.range(0) of them
+};
+
+struct BenchTargets {
+  std::vector<float> x, y, z;
+
+  size_t size() const { return x.size(); }
+  void push(float px, float py, float pz) {
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+  }
+};
+
+/**
+ * Whole workspace from the soil up to the workspace height.
+ */
+static void workspaceGrid(BenchTargets& t, float step)
+{
+  for (float z = 0; z <= benchWorkspaceHeight; z += step)
+    for (float y = benchLimitYMin; y <= benchLimitYMax; y += step)
+      for (float x = benchLimitXMin; x <= benchLimitXMax; x += step)
+        t.push(x, y, z);
+}
+
+/**
+ * Rough shape of what the tracker reports on our beds: two crop rows 24 cm
+ * apart along the direction of travel (y), most weeds in or next to a row and
+ * the rest anywhere across the bed, spread evenly along y as they pass
+ * under the arm, and low to the ground.
+ */
+static void fieldWeeds(BenchTargets& t, size_t n)
+{
+  std::mt19937 rng(1);
+  std::normal_distribution<float> inRow(0, 4.0f);
+  std::uniform_real_distribution<float> acrossBed(benchLimitXMin, benchLimitXMax);
+  std::uniform_real_distribution<float> alongBed(benchLimitYMin, benchLimitYMax);
+  std::uniform_real_distribution<float> unit(0, 1);
+  std::exponential_distribution<float> height(1 / 1.5f);
+
+  while (t.size() < n) {
+    float x = unit(rng) < 0.7f ? (unit(rng) < 0.5f ? -12.0f : 12.0f) + inRow(rng) : acrossBed(rng);
+    if (x < benchLimitXMin || x > benchLimitXMax) continue;
+    t.push(x, alongBed(rng), std::min(height(rng), benchWorkspaceHeight));
+  }
+}
+
+/**
+ * Targets in the delta frame, as robot_position() gets them from the governor.
+ */
+static void benchTargets(benchmark::State& state, BenchDistribution distribution, BenchTargets& t)
+{
+  BenchTargets tracker;
+  if (distribution == BENCH_GRID) workspaceGrid(tracker, 2.0f);
+  else fieldWeeds(tracker, state.range(0));
+
+  for (size_t i = 0; i < tracker.size(); ++i) {
+    Vector3 p = delta_frame_position(tracker.x[i], tracker.y[i], tracker.z[i], benchSoilOffset);
+    t.push(p.x, p.y, p.z);
+  }
+}
+
+/**
+ * Throughput plus time per solve, so results can be compared as ns/solve
+ * across commits (the JSON has it in seconds).
+ */
+static void reportSolves(benchmark::State& state, size_t perIteration)
+{
+  state.SetItemsProcessed(state.iterations() * perIteration);
+  state.counters["per_solve"] = benchmark::Counter((double)perIteration,
+    benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+#endif
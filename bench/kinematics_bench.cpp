@@ -0,0 +1,302 @@
+// Kinematics microbenchmarks
+//
+// Most run over both a grid of the whole workspace and field-shaped weeds
+// (benchTargets.h).  To keep results across commits:
+//   urGovernor_bench --benchmark_out=bench.json --benchmark_out_format=json
+// or build the urGovernor_bench_json target.
+
+#include "deltaRobot.h"
+#include "deltaLookupTable.h"
+#include "deltaTrajectory.h"
+#include "deltaSolver.h"
+#include "weedScheduler.h"
+#include "benchTargets.h"
+
+// google benchmark
+#include <benchmark/benchmark.h>
+
+// STD
+#include <algorithm>
+#include <vector>
+
+extern DeltaRobot robot;
+
+static void setupRobot()
+{
+  robot_set_geometry(DeltaStaticGeometry<UprootArmSpec>::measurements());
+  robot_tool_offset(0, 0, 0, benchToolOffset);
+  deltarobot_setup();
+}
+
+// Weeds per frame we see on our rows is 20-40; bench a bit either side of that
+#define FIELD_SIZES ->Arg(8)->Arg(32)->Arg(64)->Arg(1024)
+
+// One target at a time through robot_position() / update_ik()
+static void BM_RobotPosition(benchmark::State& state, BenchDistribution distribution)
+{
+  setupRobot();
+  BenchTargets t;
+  benchTargets(state, distribution, t);
+
+  int angles[3];
+  for (auto _ : state) {
+    for (size_t i = 0; i < t.size(); ++i) {
+      robot_position(t.x[i], t.y[i], t.z[i]);
+      getArmAngles(&angles[0], &angles[1], &angles[2]);
+      benchmark::DoNotOptimize(angles);
+    }
+  }
+  reportSolves(state, t.size());
+}
+BENCHMARK_CAPTURE(BM_RobotPosition, grid, BENCH_GRID);
+BENCHMARK_CAPTURE(BM_RobotPosition, field, BENCH_FIELD) FIELD_SIZES;
+
+// The IK stages on their own.  Each stage's inputs are worked out for every
+// target outside the timed loop; only storing them into the robot is timed
+// along with the stage.
+static void BM_UpdateElbows(benchmark::State& state, BenchDistribution distribution)
+{
+  setupRobot();
+  BenchTargets t;
+  benchTargets(state, distribution, t);
+
+  std::vector<Vector3> wrists(t.size() * NUM_AXIES);
+  for (size_t i = 0; i < t.size(); ++i) {
+    robot_position(t.x[i], t.y[i], t.z[i]);
+    for (int a = 0; a < NUM_AXIES; ++a) wrists[i * NUM_AXIES + a] = robot.arms[a].wrist.pos;
+  }
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < t.size(); ++i) {
+      for (int a = 0; a < NUM_AXIES; ++a) robot.arms[a].wrist.pos = wrists[i * NUM_AXIES + a];
+      update_elbows();
+      benchmark::DoNotOptimize(robot.arms[0].elbow.pos);
+      benchmark::ClobberMemory();
+    }
+  }
+  reportSolves(state, t.size());
+}
+BENCHMARK_CAPTURE(BM_UpdateElbows, grid, BENCH_GRID);
+BENCHMARK_CAPTURE(BM_UpdateElbows, field, BENCH_FIELD) FIELD_SIZES;
+
+static void BM_UpdateShoulderAngles(benchmark::State& state, BenchDistribution distribution)
+{
+  setupRobot();
+  BenchTargets t;
+  benchTargets(state, distribution, t);
+
+  std::vector<Vector3> ee(t.size());
+  for (size_t i = 0; i < t.size(); ++i) {
+    robot_position(t.x[i], t.y[i], t.z[i]);
+    ee[i] = robot.ee;
+  }
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < t.size(); ++i) {
+      robot.ee = ee[i];
+      update_shoulder_angles();
+      benchmark::DoNotOptimize(robot.arms[0].angle);
+      benchmark::ClobberMemory();
+    }
+  }
+  reportSolves(state, t.size());
+}
+BENCHMARK_CAPTURE(BM_UpdateShoulderAngles, grid, BENCH_GRID);
+BENCHMARK_CAPTURE(BM_UpdateShoulderAngles, field, BENCH_FIELD) FIELD_SIZES;
+
+// Startup, and every geometry change from the governor's config
+static void BM_DeltarobotSetup(benchmark::State& state)
+{
+  robot_set_geometry(DeltaStaticGeometry<UprootArmSpec>::measurements());
+  robot_tool_offset(0, 0, 0, benchToolOffset);
+
+  for (auto _ : state) {
+    deltarobot_setup();
+    benchmark::DoNotOptimize(robot.arms[0].angle);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DeltarobotSetup);
+
+// The governor's tracker to delta frame rotation, once per weed per frame
+static void BM_DeltaFrame(benchmark::State& state)
+{
+  BenchTargets t;
+  fieldWeeds(t, state.range(0));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < t.size(); ++i) {
+      Vector3 p = delta_frame_position(t.x[i], t.y[i], t.z[i], benchSoilOffset);
+      benchmark::DoNotOptimize(p);
+    }
+  }
+  reportSolves(state, t.size());
+}
+BENCHMARK(BM_DeltaFrame)->Arg(32)->Arg(1024);
+
+// All targets in one call
+static void BM_BatchIk(benchmark::State& state, BenchDistribution distribution)
+{
+  setupRobot();
+  BenchTargets t;
+  benchTargets(state, distribution, t);
+  std::vector<float> a1(t.size()), a2(t.size()), a3(t.size());
+
+  for (auto _ : state) {
+    int valid = robot_position_batch(&t.x[0], &t.y[0], &t.z[0], &a1[0], &a2[0], &a3[0], (int)t.size());
+    benchmark::DoNotOptimize(valid);
+    benchmark::ClobberMemory();
+  }
+  reportSolves(state, t.size());
+}
+BENCHMARK_CAPTURE(BM_BatchIk, grid, BENCH_GRID);
+BENCHMARK_CAPTURE(BM_BatchIk, field, BENCH_FIELD) FIELD_SIZES;
+
+// A weed drifting a few mm per tick, as in the tracking loop
+static void BM_IncrementalIk(benchmark::State& state)
+{
+  setupRobot();
+  const DeltaKinematics& kin = robot_kinematics();
+  float tolerance = state.range(0) / 10.0f;
+
+  DeltaIncrementalState ik;
+  Vector3 p(5, 10, 6);
+  Vector3 step(0.01f, -0.3f, 0);
+  int tick = 0;
+  for (auto _ : state) {
+    float angles[NUM_AXIES];
+    // restart the pass every 60 ticks so it stays in the workspace
+    if (++tick == 60) {
+      tick = 0;
+      p = Vector3(5, 10, 6);
+    }
+    p = p + step;
+    benchmark::DoNotOptimize(kin.solveIncremental(p, ik, angles, tolerance));
+    benchmark::DoNotOptimize(angles);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["exact_pct"] = 100.0 * ik.exact_solves / (ik.exact_solves + ik.incremental_solves);
+}
+// tolerance in mm, 0 is always exact
+BENCHMARK(BM_IncrementalIk)->Arg(0)->Arg(5)->Arg(10);
+
+// Lookup table over the governor's workspace; also reports the worst error
+// against robot_position() over the workspace grid
+static void BM_LookupTable(benchmark::State& state)
+{
+  setupRobot();
+  BenchTargets t;
+  benchTargets(state, BENCH_GRID, t);
+  const std::vector<float>& x = t.x;
+  const std::vector<float>& y = t.y;
+  const std::vector<float>& z = t.z;
+
+  DeltaLookupTable table;
+  float resolution = state.range(0) / 10.0f;
+  table.build(robot_kinematics(), Vector3(-48, -51, 3), Vector3(41, 38, 15), resolution, 0.25f);
+
+  float maxError = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    float angles[NUM_AXIES];
+    robot_position(x[i], y[i], z[i]);
+    if (!table.solve(Vector3(x[i], y[i], z[i]), angles)) continue;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      maxError = std::max(maxError, (float)fabs(angles[a] - robot.arms[a].angle));
+    }
+  }
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < x.size(); ++i) {
+      float angles[NUM_AXIES];
+      benchmark::DoNotOptimize(table.solve(Vector3(x[i], y[i], z[i]), angles));
+      benchmark::DoNotOptimize(angles);
+    }
+  }
+  reportSolves(state, x.size());
+  state.counters["max_error_deg"] = maxError;
+  state.counters["exact_cell_pct"] = 100.0 * table.exactCells() / table.cells();
+}
+// resolution in mm
+BENCHMARK(BM_LookupTable)->Arg(5)->Arg(10)->Arg(20);
+
+// One target at a time through the templated solver, geometry from a constexpr
+// spec or from run time measurements
+template <class Solver>
+static void solveEach(benchmark::State& state, const Solver& solver)
+{
+  BenchTargets t;
+  benchTargets(state, BENCH_FIELD, t);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < t.size(); ++i) {
+      float angles[NUM_AXIES];
+      benchmark::DoNotOptimize(solver.solve(Vector3(t.x[i], t.y[i], t.z[i]), angles));
+      benchmark::DoNotOptimize(angles);
+    }
+  }
+  reportSolves(state, t.size());
+}
+
+static void BM_SolveStaticGeometry(benchmark::State& state)
+{
+  DeltaSolver<DeltaStaticGeometry<UprootArmSpec> > solver(DeltaStaticGeometry<UprootArmSpec>(), Vector3(0, 0, benchToolOffset));
+  solveEach(state, solver);
+}
+BENCHMARK(BM_SolveStaticGeometry)->Arg(64)->Arg(1024);
+
+static void BM_SolveRuntimeGeometry(benchmark::State& state)
+{
+  DeltaRuntimeGeometry geometry(DeltaStaticGeometry<UprootArmSpec>::measurements());
+  DeltaSolver<DeltaRuntimeGeometry> solver(geometry, Vector3(0, 0, benchToolOffset));
+  solveEach(state, solver);
+}
+BENCHMARK(BM_SolveRuntimeGeometry)->Arg(64)->Arg(1024);
+
+// Planning a timed cartesian line, as for a move between weeds
+static void BM_TrajectoryLine(benchmark::State& state)
+{
+  setupRobot();
+  const DeltaKinematics& kin = robot_kinematics();
+  DeltaJointLimits limits = {120.0f, 600.0f, (float)state.range(1)};
+  Vector3 start(-10, 5, 6);
+  Vector3 end(start.x + state.range(0), start.y - state.range(0) / 2, 10);
+
+  DeltaTrajectory traj;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(traj.line(kin, start, end, limits));
+    traj.compact(0.1f);
+  }
+  state.counters["waypoints"] = traj.waypoints().size();
+  state.counters["duration_s"] = traj.duration();
+}
+// length in cm, jerk in deg/s^3 (0 is trapezoidal)
+BENCHMARK(BM_TrajectoryLine)->Args({5, 0})->Args({20, 0})->Args({20, 3000});
+
+// Ordering the weeds in front of the arm, from scratch every time
+static void BM_WeedSchedulerPlan(benchmark::State& state)
+{
+  setupRobot();
+  WeedSchedulerConfig config = {{120.0f, 600.0f, 0}, 0.75f, benchSoilOffset, 0, 90,
+                                benchLimitXMin, benchLimitXMax, benchLimitYMin, benchLimitYMax,
+                                8, (int)state.range(1)};
+  BenchTargets t;
+  fieldWeeds(t, state.range(0));
+  std::vector<WeedCandidate> weeds;
+  for (size_t i = 0; i < t.size(); ++i) {
+    WeedCandidate w = {(int)i, Vector3(t.x[i], t.y[i], t.z[i]), Vector3(0, -10, 0)};
+    weeds.push_back(w);
+  }
+
+  float rest[NUM_AXIES] = {0, 0, 0};
+  int expanded = 0;
+  for (auto _ : state) {
+    WeedScheduler scheduler(robot_kinematics(), config);
+    benchmark::DoNotOptimize(scheduler.plan(rest, weeds).size());
+    expanded = scheduler.expanded();
+  }
+  state.counters["expanded"] = expanded;
+}
+// weeds on offer, horizon
+BENCHMARK(BM_WeedSchedulerPlan)->Args({8, 3})->Args({32, 4})->Args({32, 5});
+
+BENCHMARK_MAIN();
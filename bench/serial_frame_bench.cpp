@@ -0,0 +1,101 @@
+// Serial link framing throughput
+//
+// Frames the size of a CmdMsg, decoded from buffers the size the serial node
+// reads at a time.  frames/s is the figure to compare against what the link
+// carries: 115200 baud is about 310 frames/s of these.
+
+#include "serialFrame.h"
+
+// google benchmark
+#include <benchmark/benchmark.h>
+
+// STD
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+// about sizeof(SerialUtils::CmdMsg)
+static const size_t benchPayload = 32;
+
+static std::vector<uint8_t> benchStream(size_t frames, unsigned corruptEvery = 0)
+{
+  std::mt19937 rng(1);
+  std::vector<uint8_t> stream;
+  uint8_t payload[benchPayload];
+  uint8_t frame[SERIAL_FRAME_MAX_SIZE];
+  for (size_t i = 0; i < frames; ++i) {
+    for (size_t b = 0; b < benchPayload; ++b) payload[b] = (uint8_t)rng();
+    size_t size = serial_frame_encode((uint8_t)i, payload, benchPayload, frame);
+    if (corruptEvery && i % corruptEvery == 0) frame[1 + rng() % (size - 1)] ^= 0x40;
+    stream.insert(stream.end(), frame, frame + size);
+  }
+  return stream;
+}
+
+static void reportFrames(benchmark::State& state, size_t perIteration, size_t bytes)
+{
+  state.SetItemsProcessed(state.iterations() * perIteration);
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["frames/s"] = benchmark::Counter((double)perIteration, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_FrameEncode(benchmark::State& state)
+{
+  uint8_t payload[benchPayload] = {0};
+  uint8_t frame[SERIAL_FRAME_MAX_SIZE];
+  uint8_t sequence = 0;
+
+  for (auto _ : state) {
+    size_t size = serial_frame_encode(sequence++, payload, benchPayload, frame);
+    benchmark::DoNotOptimize(size);
+    benchmark::ClobberMemory();
+  }
+  reportFrames(state, 1, benchPayload + SERIAL_FRAME_OVERHEAD);
+}
+BENCHMARK(BM_FrameEncode);
+
+// 1024 frames, read range(0) bytes at a time
+static void BM_FrameDecode(benchmark::State& state)
+{
+  const size_t frames = 1024;
+  std::vector<uint8_t> stream = benchStream(frames);
+  size_t chunk = state.range(0);
+
+  for (auto _ : state) {
+    SerialFrameDecoder decoder;
+    for (size_t start = 0; start < stream.size(); start += chunk) {
+      size_t n = std::min(chunk, stream.size() - start);
+      size_t used = 0;
+      while (used < n) {
+        SerialFrame frame;
+        bool complete;
+        used += decoder.decode(&stream[start + used], n - used, frame, complete);
+        benchmark::DoNotOptimize(frame);
+      }
+    }
+  }
+  reportFrames(state, frames, stream.size());
+}
+BENCHMARK(BM_FrameDecode)->Arg(1)->Arg(37)->Arg(256)->Arg(4096);
+
+// One frame in 16 corrupted, so the decoder keeps resyncing
+static void BM_FrameDecodeCorrupted(benchmark::State& state)
+{
+  const size_t frames = 1024;
+  std::vector<uint8_t> stream = benchStream(frames, 16);
+
+  for (auto _ : state) {
+    SerialFrameDecoder decoder;
+    size_t used = 0;
+    while (used < stream.size()) {
+      SerialFrame frame;
+      bool complete;
+      used += decoder.decode(&stream[used], stream.size() - used, frame, complete);
+      benchmark::DoNotOptimize(frame);
+    }
+  }
+  reportFrames(state, frames, stream.size());
+}
+BENCHMARK(BM_FrameDecodeCorrupted);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#ifndef ARMCYCLE_H
+#define ARMCYCLE_H
+//------------------------------------------------------------------------------
+// The governor's state machine for one arm, on its own.
+//
+//   idle     -> waiting for a weed to work on
+//   approach -> moves follow the weed until the arm gets there
+//   dwell    -> the end effector works on it for the dwell time
+//   retract  -> the arm on its way up, to wait for the next one
+//
+// The governor says when a weed is taken on, a move goes out or the arm is
+// sent up; due() says where the clock and the last move's ack have got it
+// since.  Times are in seconds on any one clock.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+enum ArmState { ARM_IDLE, ARM_APPROACH, ARM_DWELL, ARM_RETRACT };
+
+struct ArmCycleConfig {
+  double dwell;         // time the end effector works on a weed (s)
+  double spinup;        // time it takes to get up to speed (s)
+  double no_move_wait;  // approach with no move sent, before it dwells anyway (s)
+};
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+const char *arm_state_name(ArmState state);
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class ArmCycle {
+public:
+  explicit ArmCycle(const ArmCycleConfig &config);
+
+  ArmState state() const { return state_; }
+  double stateStart() const { return state_start_; }
+  // On a weed, approaching it or dwelling
+  bool working() const { return state_ == ARM_APPROACH || state_ == ARM_DWELL; }
+
+  /**
+   * Change state.  An approach starts with no move sent.
+   */
+  void enter(ArmState state, double now);
+
+  /**
+   * A move went out, for the approach or the retract
+   * @input arrival when the arm should have got there
+   */
+  void moved(double arrival);
+
+  // Whether the approach has sent a move, and when the last move gets there
+  bool moveSent() const { return move_sent_; }
+  double arrival() const { return arrival_; }
+
+  /**
+   * Where the clock has got the arm to.  The end of a dwell is idle, the
+   * weed is done.
+   * @input arrived the last move has been acked
+   */
+  ArmState due(double now, bool arrived) const;
+
+  /**
+   * Time until the end effector should be started so it is up to speed when
+   * the arm gets to the weed, 0 or less once it should be on
+   * @return a long way off if no move has gone out to a weed
+   */
+  double spinupIn(double now) const;
+
+  // Dwell time left, 0 if not dwelling
+  double dwellLeft(double now) const;
+  // The dwell went the full time
+  bool dwellDone(double now) const { return state_ == ARM_DWELL && now - state_start_ >= config_.dwell; }
+
+  /**
+   * Time until the arm is done with what it is doing now, counting the dwell
+   * still to come on an approach (s)
+   */
+  double timeToFree(double now) const;
+
+private:
+  ArmCycleConfig config_;
+  ArmState state_;
+  double state_start_;
+  bool move_sent_;
+  double arrival_;
+};
+
+#endif
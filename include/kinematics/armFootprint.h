@@ -0,0 +1,85 @@
+#ifndef ARMFOOTPRINT_H
+#define ARMFOOTPRINT_H
+//------------------------------------------------------------------------------
+// What the delta arm hides of the soil from the camera.
+//
+// The shoulders, elbows, wrists and tool come from forward kinematics, and
+// each link (the three biceps and forearms, and the tool) is projected from
+// the camera onto the soil.  A link is taken as a rod of the given radius,
+// so its shadow is bounded by the box around its projected ends, grown by
+// the radius scaled to the soil.  The boxes err on the large side.  Parts of
+// the arm level with the camera or above it are out of its view.
+//
+// All positions are in the tracker frame, z up from the soil (cm).
+//------------------------------------------------------------------------------
+
+#include "deltaKinematics.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * Axis aligned rectangle on the soil
+ */
+struct GroundRect {
+  float x_min, x_max, y_min, y_max;
+
+  bool overlaps(const GroundRect &o) const {
+    return x_min <= o.x_max && o.x_min <= x_max && y_min <= o.y_max && o.y_min <= y_max;
+  }
+};
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class ArmFootprint {
+public:
+  /**
+   * @input kinematics of the arm, in its delta frame
+   * @input mount delta frame origin in the tracker frame (x, y)
+   * @input soilOffset height of the soil in the delta frame
+   * @input camera optical centre
+   * @input linkRadius half the thickness of the links
+   */
+  ArmFootprint(const DeltaKinematics &kinematics, const Vector3 &mount, float soilOffset,
+               const Vector3 &camera, float linkRadius);
+
+  /**
+   * Shadow of each link on the soil
+   * @return false if the arms can't close at those angles
+   */
+  bool project(const float angles[NUM_AXIES], std::vector<GroundRect> &shadows) const;
+
+  /**
+   * Does the arm at these angles hide any of the regions?  Poses that can't
+   * be worked out do.
+   */
+  bool occludes(const float angles[NUM_AXIES], const std::vector<GroundRect> &regions) const;
+
+  /**
+   * Lowest tool height over (x, y) at which the arm hides none of the regions
+   * and every shoulder is within its limits, going up from zMin in steps to
+   * zMax.
+   * @input maxAngle shoulders go from 0 to this (degrees)
+   * @output angles the pose there
+   * @return false if there is none in that range
+   */
+  bool clearingPose(float x, float y, float zMin, float zMax, float step, float maxAngle,
+                    const std::vector<GroundRect> &regions, float angles[NUM_AXIES]) const;
+
+private:
+  Vector3 toTracker(const Vector3 &p) const;
+  void addShadow(const Vector3 &a, const Vector3 &b, std::vector<GroundRect> &shadows) const;
+
+  const DeltaKinematics &kinematics_;
+  Vector3 mount_;
+  float soil_offset_;
+  Vector3 camera_;
+  float link_radius_;
+};
+
+#endif
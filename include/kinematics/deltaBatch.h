@@ -0,0 +1,46 @@
+#ifndef DELTABATCH_H
+#define DELTABATCH_H
+//------------------------------------------------------------------------------
+// Batched (structure-of-arrays) inverse kinematics for the delta arm.
+//
+// Solves many end effector targets in one call, several targets per SIMD
+// register.  The math is the same circle intersection as update_elbows() and
+// update_shoulder_angles(), reduced to the plane of each bicep so it needs no
+// per-arm Vector3 state and can run on any number of targets at once.
+//------------------------------------------------------------------------------
+
+#include "configuration.h"
+
+/**
+ * Everything the batched solver needs to know about the robot.
+ * Filled from the same constants deltarobot_setup() uses.
+ */
+struct DeltaBatchGeometry {
+  float cos_arm[NUM_AXIES];  // direction of each shoulder in the base plane
+  float sin_arm[NUM_AXIES];
+  float shoulder_to_elbow;   // bicep length
+  float elbow_to_wrist;      // forearm length
+  float wrist_offset;        // EFFECTOR_TO_WRIST - CENTER_TO_SHOULDER
+  float shoulder_z;          // height of the shoulders above the floor
+  float tool_x;              // active tool offset
+  float tool_y;
+  float tool_z;
+};
+
+/**
+ * Inverse kinematics for n targets.
+ * @input x,y,z target positions (tool tip, delta frame)
+ * @output angle1..3 shoulder angles in degrees.  NaN if a target is unreachable.
+ * @return number of targets with a valid solution
+ */
+int delta_ik_batch(const DeltaBatchGeometry &geometry,
+                   const float *x, const float *y, const float *z,
+                   float *angle1, float *angle2, float *angle3,
+                   int n);
+
+/**
+ * Number of targets solved per SIMD register on this build.
+ */
+int delta_ik_batch_width();
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef DELTAFRAME_H
+#define DELTAFRAME_H
+//------------------------------------------------------------------------------
+// Tracker (camera) frame to delta arm frame.
+//
+// Based on our setup the tracker's X and Y are switched and rotated by +60
+// degrees relative to the Delta library:
+//   x' = x*cos(theta) - y*sin(theta)
+//   y' = x*sin(theta) + y*cos(theta)
+// Header only so the governor and the benchmarks run the same code.
+//------------------------------------------------------------------------------
+
+#include "vector3.h"
+
+/**
+ * Tracker position to delta frame.
+ * @input soilOffset height of the soil in the delta frame; tracker z = 0 is
+ *        the ground and always positive above it
+ */
+inline Vector3 delta_frame_position(float x, float y, float z, float soilOffset) {
+  return Vector3((float)(y*(0.5) - x*(0.866)),
+                 (float)(y*(0.866) + x*(0.5)),
+                 z + soilOffset);
+}
+
+/**
+ * Tracker velocity to delta frame (no offset).
+ */
+inline Vector3 delta_frame_velocity(float vx, float vy) {
+  return Vector3((float)(vy*(0.5) - vx*(0.866)),
+                 (float)(vy*(0.866) + vx*(0.5)),
+                 0);
+}
+
+/**
+ * Delta frame position back to the tracker frame.  The rotation is its own
+ * inverse.
+ */
+inline Vector3 tracker_frame_position(const Vector3 &p, float soilOffset) {
+  return Vector3((float)(p.y*(0.5) - p.x*(0.866)),
+                 (float)(p.y*(0.866) + p.x*(0.5)),
+                 p.z - soilOffset);
+}
+
+#endif
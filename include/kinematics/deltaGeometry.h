@@ -0,0 +1,110 @@
+#ifndef DELTAGEOMETRY_H
+#define DELTAGEOMETRY_H
+//------------------------------------------------------------------------------
+// Geometry descriptors for the delta arm.
+//
+// The solver in deltaSolver.h is templated on one of these.  A descriptor
+// answers the same questions either way: DeltaStaticGeometry from constants
+// known when compiling, so they fold into the solver, and
+// DeltaRuntimeGeometry from measurements read at startup (the governor's
+// YAML config), with the per-arm trig worked out once.
+//------------------------------------------------------------------------------
+
+#include "vector3.h"
+#include "configuration.h"
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * Physical measurements of an arm (cm)
+ */
+struct DeltaGeometry {
+  float center_to_shoulder;
+  float shoulder_to_elbow;
+  float elbow_to_wrist;
+  float effector_to_wrist;
+  float center_to_floor;
+};
+
+/**
+ * Per-arm constants derived from the geometry
+ */
+struct DeltaArmGeometry {
+  Vector3 shoulder;
+  Vector3 plane_ortho;     // unit vector from center towards the shoulder
+  Vector3 plane_normal;    // normal of the plane the bicep swings in
+  Vector3 elbow_relative;  // elbow with the bicep horizontal
+  Vector3 wrist_relative;  // wrist relative to the end effector
+};
+
+/**
+ * The arm as built.  Specs for DeltaStaticGeometry are structs like this one.
+ */
+struct UprootArmSpec {
+  static constexpr float center_to_shoulder = 7.5f;  // cm
+  static constexpr float shoulder_to_elbow = 30.0f;  // cm
+  static constexpr float elbow_to_wrist = 45.0f;     // cm
+  static constexpr float effector_to_wrist = 5.0f;   // cm
+  static constexpr float center_to_floor = 55.0f;    // cm
+};
+
+//------------------------------------------------------------------------------
+// DESCRIPTORS
+//------------------------------------------------------------------------------
+
+/**
+ * Geometry fixed at compile time.  Everything is constexpr, so a solver
+ * instantiated on it has no geometry loads at all.
+ */
+template <class Spec>
+struct DeltaStaticGeometry {
+  static_assert(NUM_AXIES == 3, "arm directions are tabulated for 3 arms");
+
+  static constexpr float centerToShoulder() { return Spec::center_to_shoulder; }
+  static constexpr float shoulderToElbow() { return Spec::shoulder_to_elbow; }
+  static constexpr float elbowToWrist() { return Spec::elbow_to_wrist; }
+  static constexpr float effectorToWrist() { return Spec::effector_to_wrist; }
+  static constexpr float centerToFloor() { return Spec::center_to_floor; }
+
+  // Direction of each shoulder in the base plane: 0, 120 and 240 degrees
+  static constexpr float armCos(int i) { return i == 0 ? 1.0f : -0.5f; }
+  static constexpr float armSin(int i) { return i == 0 ? 0.0f : (i == 1 ? 0.866025404f : -0.866025404f); }
+
+  static constexpr DeltaGeometry measurements() {
+    return DeltaGeometry{centerToShoulder(), shoulderToElbow(), elbowToWrist(),
+                         effectorToWrist(), centerToFloor()};
+  }
+};
+
+/**
+ * Geometry read at run time.  The trig and the per-arm vectors are worked
+ * out once here rather than on every solve.
+ */
+class DeltaRuntimeGeometry {
+public:
+  // Zeroed; assign a configured one before use
+  DeltaRuntimeGeometry();
+  explicit DeltaRuntimeGeometry(const DeltaGeometry &geometry);
+
+  float centerToShoulder() const { return geometry_.center_to_shoulder; }
+  float shoulderToElbow() const { return geometry_.shoulder_to_elbow; }
+  float elbowToWrist() const { return geometry_.elbow_to_wrist; }
+  float effectorToWrist() const { return geometry_.effector_to_wrist; }
+  float centerToFloor() const { return geometry_.center_to_floor; }
+
+  float armCos(int i) const { return cos_[i]; }
+  float armSin(int i) const { return sin_[i]; }
+
+  const DeltaGeometry &measurements() const { return geometry_; }
+  const DeltaArmGeometry &arm(int i) const { return arms_[i]; }
+
+private:
+  DeltaGeometry geometry_;
+  float cos_[NUM_AXIES];
+  float sin_[NUM_AXIES];
+  DeltaArmGeometry arms_[NUM_AXIES];
+};
+
+#endif
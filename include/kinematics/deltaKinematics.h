@@ -0,0 +1,141 @@
+#ifndef DELTAKINEMATICS_H
+#define DELTAKINEMATICS_H
+//------------------------------------------------------------------------------
+// Reentrant delta arm kinematics.
+//
+// All geometry lives in the instance and every solver method is const, so one
+// object can be shared by any number of threads and several arms can each
+// have their own.  The C functions in deltaRobot.h are a shim over this.
+// The geometry is a run time one; solve() is DeltaSolver's.
+//------------------------------------------------------------------------------
+
+#include "vector3.h"
+#include "configuration.h"
+#include "deltaBatch.h"
+#include "deltaGeometry.h"
+#include "deltaSolver.h"
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * Warm start for DeltaKinematics::solveIncremental().  One per target being
+ * tracked; not shared between threads.
+ */
+struct DeltaIncrementalState {
+  bool valid;
+  Vector3 anchor;                // last exactly solved target
+  float angles[NUM_AXIES];       // its angles
+  float jinv[NUM_AXIES][3];      // its inverse Jacobian
+  int exact_solves;
+  int incremental_solves;
+
+  DeltaIncrementalState() : valid(false), exact_solves(0), incremental_solves(0) {}
+  void reset() { valid = false; }
+};
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class DeltaKinematics {
+public:
+  /**
+   * An unconfigured solver; assign a configured one before use.
+   */
+  DeltaKinematics();
+
+  explicit DeltaKinematics(const DeltaGeometry &geometry,
+                           const Vector3 &toolOffset = Vector3(0, 0, 0));
+
+  /**
+   * Inverse kinematics.
+   * @input target tool position
+   * @output angles shoulder angles in degrees
+   * @return false if the target can't be reached
+   */
+  bool solve(const Vector3 &target, float angles[NUM_AXIES]) const;
+
+  /**
+   * Forward kinematics.
+   * @input angles shoulder angles in degrees
+   * @output target tool position
+   * @return false if the arms can't close at those angles
+   */
+  bool forward(const float angles[NUM_AXIES], Vector3 &target) const;
+
+  /**
+   * Inverse Jacobian, d(angles)/d(target) in degrees per cm.
+   * Row i is arm i.  Closed form from differentiating the forearm length
+   * constraint |wrist - elbow| = ELBOW_TO_WRIST for each arm.
+   * @input target tool position matching angles (from solve() or forward())
+   * @return false at a singularity
+   */
+  bool inverseJacobian(const Vector3 &target, const float angles[NUM_AXIES],
+                       float jinv[NUM_AXIES][3]) const;
+
+  /**
+   * Jacobian, d(target)/d(angles) in cm per degree.  Column i is arm i.
+   * @return false if the pose can't be reached or is singular
+   */
+  bool jacobian(const float angles[NUM_AXIES], float j[3][NUM_AXIES]) const;
+
+  /**
+   * Shoulder rates (degrees/s) that move the tool at velocity (cm/s).
+   */
+  bool jointVelocity(const Vector3 &target, const float angles[NUM_AXIES],
+                     const Vector3 &velocity, float rates[NUM_AXIES]) const;
+
+  /**
+   * Inverse kinematics for a target that moves a little between calls.
+   * Within tolerance (cm) of the last exact solve the angles are a first
+   * order correction through the saved inverse Jacobian, otherwise this is
+   * solve() and the state is re-anchored.  The error grows with the square
+   * of the step, and quickly as a shoulder nears the straight elbow.  On our
+   * geometry at 0.5cm it is under 0.035 degree while every shoulder is below
+   * 80 degrees, up to 0.11 degree between 80 and 90, and unbounded past that.
+   */
+  bool solveIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                        float angles[NUM_AXIES], float tolerance) const;
+
+  /**
+   * solveIncremental() in two halves, for a caller with its own full solve
+   * (the lookup table).  The step is false, counted as an exact solve, when
+   * the target is too far from the anchor; anchor on the full solve's angles.
+   */
+  bool stepIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                       float angles[NUM_AXIES], float tolerance) const;
+  void anchorIncremental(const Vector3 &target, const float angles[NUM_AXIES],
+                         DeltaIncrementalState &state) const;
+
+  /**
+   * Inverse kinematics for n targets, see delta_ik_batch()
+   */
+  int solveBatch(const float *x, const float *y, const float *z,
+                 float *angle1, float *angle2, float *angle3, int n) const;
+
+  // Individual IK stages, used by the C shim
+  Vector3 wristPosition(int arm, const Vector3 &ee) const;
+  Vector3 elbowPosition(int arm, const Vector3 &wrist, Vector3 *wop = 0) const;
+  float shoulderAngle(int arm, const Vector3 &elbow) const;
+
+  // Elbow position for a given shoulder angle (degrees)
+  Vector3 elbowAt(int arm, float angle) const;
+  // d(elbow)/d(angle) per degree
+  Vector3 elbowTangent(int arm, float angle) const;
+
+  void setToolOffset(const Vector3 &toolOffset);
+  const Vector3 &toolOffset() const { return solver_.toolOffset(); }
+
+  const DeltaGeometry &geometry() const { return solver_.geometry().measurements(); }
+  const DeltaArmGeometry &arm(int i) const { return solver_.geometry().arm(i); }
+  const DeltaBatchGeometry &batchGeometry() const { return batch_; }
+  const DeltaSolver<DeltaRuntimeGeometry> &solver() const { return solver_; }
+
+private:
+  DeltaSolver<DeltaRuntimeGeometry> solver_;
+  DeltaBatchGeometry batch_;
+};
+
+#endif
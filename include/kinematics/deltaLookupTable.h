@@ -0,0 +1,109 @@
+#ifndef DELTALOOKUPTABLE_H
+#define DELTALOOKUPTABLE_H
+//------------------------------------------------------------------------------
+// Precomputed inverse kinematics over a box of the workspace.
+//
+// Joint angles are stored on a regular 3D grid and trilinearly interpolated.
+// Cells where interpolation is worse than the requested error bound (or that
+// touch unreachable points) are flagged at build time and answered with the
+// exact solver instead.  The error is checked at the middle of each cell and
+// of its faces and edges, where it peaks; the bound is an estimate, points in
+// between can be a little over it (about 6% at 0.5cm and 0.25 degree).  Tables are saved to disk and memory-mapped on the
+// next start, keyed by a hash of everything that went into them.
+//------------------------------------------------------------------------------
+
+#include "deltaKinematics.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class DeltaLookupTable {
+public:
+  DeltaLookupTable();
+  ~DeltaLookupTable();
+
+  /**
+   * Compute the table.
+   * @input kinematics solver (geometry and tool offset) to tabulate
+   * @input min,max corners of the box (delta frame, tool position)
+   * @input resolution grid spacing (cm)
+   * @input maxErrorDeg interpolation error above which a cell uses exact IK,
+   *                    as sampled (see above)
+   * @input threads number of worker threads, 0 for one per core
+   */
+  bool build(const DeltaKinematics &kinematics,
+             const Vector3 &min, const Vector3 &max,
+             float resolution, float maxErrorDeg, int threads = 0);
+
+  // Write the table to disk
+  bool save(const std::string &path) const;
+
+  // Map a table from disk.  Fails if it wasn't built with this key.
+  bool map(const std::string &path, const DeltaKinematics &kinematics, uint64_t key);
+
+  /**
+   * Map the table at path if it matches, otherwise build it and save it there.
+   * @return false only if the table could not be built
+   */
+  bool loadOrBuild(const DeltaKinematics &kinematics,
+                   const Vector3 &min, const Vector3 &max,
+                   float resolution, float maxErrorDeg,
+                   const std::string &path);
+
+  /**
+   * Inverse kinematics through the table, falling back to the exact solver
+   * outside the box and in flagged cells.  Same contract as DeltaKinematics::solve().
+   */
+  bool solve(const Vector3 &target, float angles[NUM_AXIES]) const;
+
+  /**
+   * DeltaKinematics::solveIncremental() with solve() above for the full
+   * solves it falls back to.
+   */
+  bool solveIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                        float angles[NUM_AXIES], float tolerance) const;
+
+  /**
+   * Interpolation only.
+   * @return false if the target is outside the table or in a flagged cell
+   */
+  bool lookup(const Vector3 &target, float angles[NUM_AXIES]) const;
+
+  // Hash of everything that went into a table
+  static uint64_t key(const DeltaKinematics &kinematics,
+                      const Vector3 &min, const Vector3 &max,
+                      float resolution, float maxErrorDeg);
+
+  bool valid() const { return angles_ != 0; }
+  bool mapped() const { return map_ != 0; }
+
+  // Cells answered by exact IK / all cells
+  int exactCells() const;
+  int cells() const;
+
+private:
+  // non-copyable, may own a mapping
+  DeltaLookupTable(const DeltaLookupTable &);
+  DeltaLookupTable &operator=(const DeltaLookupTable &);
+
+  void unmap();
+  bool interpolate(int cell, float fx, float fy, float fz, float angles[NUM_AXIES]) const;
+
+  DeltaKinematics kinematics_;
+  uint64_t key_;
+  float min_[3];
+  float step_;
+  int dims_[3];       // nodes per axis
+
+  const float *angles_;    // NUM_AXIES per node, x fastest
+  const uint8_t *exact_;   // one per cell
+
+  std::vector<float> own_angles_;
+  std::vector<uint8_t> own_exact_;
+
+  void *map_;
+  size_t map_size_;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef DELTAREACHABILITY_H
+#define DELTAREACHABILITY_H
+//------------------------------------------------------------------------------
+// Reachability map over a box of the workspace.
+//
+// Stores, on a regular grid, how far (in degrees) the closest shoulder is from
+// its joint limits at each point; negative where a limit is exceeded or the
+// arm can't reach at all.  Queries interpolate the grid, so "can the arm get
+// there, and with what margin" costs the same anywhere in the box.
+//------------------------------------------------------------------------------
+
+#include "deltaKinematics.h"
+
+#include <vector>
+
+class DeltaReachability {
+public:
+  // Margin stored for points the arm can't reach at all
+  static const float UNREACHABLE;
+
+  DeltaReachability();
+
+  /**
+   * Compute the map.
+   * @input kinematics solver to use
+   * @input min,max corners of the box (delta frame, tool position)
+   * @input resolution grid spacing (cm)
+   * @input minAngle,maxAngle joint limits (degrees)
+   * @input threads number of worker threads, 0 for one per core
+   */
+  bool build(const DeltaKinematics &kinematics,
+             const Vector3 &min, const Vector3 &max, float resolution,
+             float minAngle, float maxAngle, int threads = 0);
+
+  /**
+   * Joint limit margin in degrees; UNREACHABLE outside the box.
+   * Interpolated, so it runs slightly pessimistic within a cell of the edge
+   * of the reachable space.
+   */
+  float margin(const Vector3 &target) const;
+
+  bool reachable(const Vector3 &target, float minMargin = 0) const {
+    return margin(target) >= minMargin;
+  }
+
+  /**
+   * margin() for n targets.
+   * @return number of targets with margin >= minMargin
+   */
+  int query(const float *x, const float *y, const float *z,
+            float *margins, int n, float minMargin = 0) const;
+
+  bool valid() const { return !margins_.empty(); }
+
+private:
+  float min_[3];
+  float inv_step_;
+  int dims_[3];
+  std::vector<float> margins_;  // one per node, x fastest
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "vector3.h"
 #include "configuration.h"
+#include "deltaKinematics.h"
 
 //------------------------------------------------------------------------------
 // Prototypes
@@ -22,6 +23,12 @@ void update_shoulder_angles();
 void robot_tool_offset(int axis,float x,float y,float z);
 Vector3 robot_get_end_plus_offset();
 int getArmAngles(int* angle1Deg, int* angle2Deg, int* angle3Deg);
+int robot_position_batch(const float* npx, const float* npy, const float* npz,
+                         float* angle1Deg, float* angle2Deg, float* angle3Deg, int n);
+void robot_batch_geometry(DeltaBatchGeometry* geometry);
+DeltaGeometry robot_geometry();
+void robot_set_geometry(const DeltaGeometry& geometry);
+const DeltaKinematics& robot_kinematics();
 
 //------------------------------------------------------------------------------
 // STRUCTS
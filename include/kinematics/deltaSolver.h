@@ -0,0 +1,80 @@
+#ifndef DELTASOLVER_H
+#define DELTASOLVER_H
+//------------------------------------------------------------------------------
+// Inverse kinematics templated on a geometry descriptor (deltaGeometry.h).
+//
+// The same circle intersection as DeltaKinematics' IK stages, reduced to the
+// plane of each bicep like deltaBatch.cpp.  DeltaKinematics solves through
+// DeltaSolver<DeltaRuntimeGeometry>; a build for one particular arm can use
+// DeltaSolver<DeltaStaticGeometry<Spec>> and get the geometry folded in.
+//------------------------------------------------------------------------------
+
+#include "deltaGeometry.h"
+
+#include <math.h>
+
+template <class G>
+class DeltaSolver {
+public:
+  DeltaSolver() : tool_offset_(0, 0, 0) {}
+
+  explicit DeltaSolver(const G &geometry, const Vector3 &toolOffset = Vector3(0, 0, 0))
+    : geometry_(geometry), tool_offset_(toolOffset) {}
+
+  /**
+   * Inverse kinematics.
+   * @input target tool position
+   * @output angles shoulder angles in degrees, NaN for an arm that can't reach
+   * @return false if the target can't be reached
+   */
+  bool solve(const Vector3 &target, float angles[NUM_AXIES]) const {
+    // per component: the arms only read scalars, so a packed subtract would
+    // just go through memory
+    Vector3 ee(target.x - tool_offset_.x, target.y - tool_offset_.y, target.z - tool_offset_.z);
+    bool ok = true;
+    for (int i = 0; i < NUM_AXIES; ++i) {
+      angles[i] = solveArm(i, ee);
+      if (isnan(angles[i])) ok = false;
+    }
+    return ok;
+  }
+
+  /**
+   * Shoulder angle (degrees) of one arm for an end effector position.
+   * u is the wrist's distance from the shoulder along the plane of the
+   * bicep, v its height relative to the shoulder and a its distance off the
+   * plane.
+   */
+  float solveArm(int i, const Vector3 &ee) const {
+    const float r0sq = geometry_.shoulderToElbow() * geometry_.shoulderToElbow();
+    const float l2sq = geometry_.elbowToWrist() * geometry_.elbowToWrist();
+
+    float u = ee.x * geometry_.armCos(i) + ee.y * geometry_.armSin(i)
+            + (geometry_.effectorToWrist() - geometry_.centerToShoulder());
+    float v = ee.z - geometry_.centerToFloor();
+    float a = ee.y * geometry_.armCos(i) - ee.x * geometry_.armSin(i);
+
+    // forearm projected onto the plane of the bicep
+    float r1sq = l2sq - a * a;
+    if (r1sq < 0) return NAN;
+    float d = sqrtf(u * u + v * v);
+    float c = (r0sq - r1sq + d * d) / (d + d);
+    float h = sqrtf(r0sq - c * c);
+
+    // elbow relative to the shoulder, scaled by d (which does not change the angle)
+    float ex = u * c - v * h;
+    float ey = v * c + u * h;
+    return atan2f(-ey, ex) * (float)RAD2DEG;
+  }
+
+  void setToolOffset(const Vector3 &toolOffset) { tool_offset_ = toolOffset; }
+  const Vector3 &toolOffset() const { return tool_offset_; }
+
+  const G &geometry() const { return geometry_; }
+
+private:
+  G geometry_;
+  Vector3 tool_offset_;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef DELTATRAJECTORY_H
+#define DELTATRAJECTORY_H
+//------------------------------------------------------------------------------
+// Time-parameterized moves for the delta arm.
+//
+// A move is a path (a cartesian polyline with blended corners, or a straight
+// line in joint space) cut into short pieces like robot_line(), then timed by
+// a rest-to-rest profile along its length.  Every waypoint carries the time
+// the arm passes it, so the arrival time is known as soon as the move is
+// planned.
+//------------------------------------------------------------------------------
+
+#include "deltaKinematics.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * Limits every shoulder has to stay within
+ */
+struct DeltaJointLimits {
+  float velocity;  // degrees/s
+  float accel;     // degrees/s^2
+  float jerk;      // degrees/s^3, 0 for a trapezoidal profile
+};
+
+struct DeltaWaypoint {
+  float t;                  // seconds from the start of the move
+  float angles[NUM_AXIES];  // degrees
+};
+
+//------------------------------------------------------------------------------
+// CLASSES
+//------------------------------------------------------------------------------
+
+/**
+ * Rest-to-rest profile over a distance.  Trapezoidal velocity when jerk is 0,
+ * otherwise the 7 segment S-curve.  If the distance is too short to reach
+ * the velocity limit the peak velocity is lowered.  Any consistent units.
+ */
+class DeltaMotionProfile {
+public:
+  DeltaMotionProfile();
+
+  /**
+   * @return false unless velocity and accel are positive and distance isn't negative
+   */
+  bool plan(float distance, float velocity, float accel, float jerk = 0);
+
+  /**
+   * State at time t (clamped to the move)
+   * @output s,v,a position, velocity and acceleration
+   */
+  void sample(float t, float &s, float &v, float &a) const;
+  float position(float t) const;
+
+  // Inverse of position()
+  float timeAt(float s) const;
+
+  float duration() const { return duration_; }
+  float distance() const { return distance_; }
+  float peakVelocity() const { return peak_velocity_; }
+
+private:
+  // Accelerating from rest over the first t seconds
+  void accelerate(float t, float &s, float &v, float &a) const;
+
+  float distance_;
+  float jerk_;
+  float peak_accel_;
+  float peak_velocity_;
+  float tj_;  // each jerk phase
+  float ta_;  // whole acceleration phase
+  float tv_;  // cruise
+  float duration_;
+};
+
+/**
+ * A timed move through a list of waypoints.
+ */
+class DeltaTrajectory {
+public:
+  DeltaTrajectory() {}
+
+  /**
+   * Straight cartesian line between two tool positions.
+   * @return false if any point on the way can't be reached
+   */
+  bool line(const DeltaKinematics &kinematics, const Vector3 &start, const Vector3 &end,
+            const DeltaJointLimits &limits);
+
+  /**
+   * Cartesian polyline, each corner replaced by a parabolic blend that
+   * starts blendRadius (cm) before it, so the arm doesn't stop at the corners.
+   * The profile is timed against the steepest d(angle)/d(path) on the path,
+   * which keeps every joint under the velocity limit; acceleration is held to
+   * the limit only where the path doesn't curve sharply in joint space.
+   */
+  bool path(const DeltaKinematics &kinematics, const std::vector<Vector3> &points,
+            float blendRadius, const DeltaJointLimits &limits);
+
+  /**
+   * Straight line in joint space, all shoulders arriving together.  This is
+   * what the motor controller runs for a single angle command, so its
+   * duration is when the arm gets there.
+   */
+  bool joint(const float start[NUM_AXIES], const float end[NUM_AXIES],
+             const DeltaJointLimits &limits);
+
+  /**
+   * Angles at time t, interpolated between waypoints and clamped to the move
+   */
+  bool sample(float t, float angles[NUM_AXIES]) const;
+
+  /**
+   * Drop waypoints that linear interpolation between their neighbours
+   * reproduces to within tolerance (degrees).
+   */
+  void compact(float tolerance);
+
+  void clear();
+  bool valid() const { return !waypoints_.empty(); }
+
+  float duration() const { return valid() ? waypoints_.back().t : 0; }
+  const std::vector<DeltaWaypoint> &waypoints() const { return waypoints_; }
+  const DeltaMotionProfile &profile() const { return profile_; }
+
+private:
+  // Time the waypoints from their distance along the path, rate is the
+  // largest d(angle)/d(path) anywhere on it
+  bool time(const std::vector<float> &s, float rate, const DeltaJointLimits &limits);
+
+  std::vector<DeltaWaypoint> waypoints_;
+  DeltaMotionProfile profile_;
+};
+
+#endif
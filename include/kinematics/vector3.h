@@ -9,35 +9,48 @@
 
 #include <math.h>
 
+#include <type_traits>
+
 #ifndef PI
 #define PI (3.1415926)
 #endif
 
-class Vector3 {
+//------------------------------------------------------------------------------
+// x, y, z are stored in a 16 byte aligned 4 float register with the last lane
+// (w) held at 0, so the arithmetic below is one SSE/NEON instruction per
+// operation.  Builds without either get the plain per-component code.
+// Vector3 is trivially copyable, so arrays of it can be memcpy'd and passed
+// around in registers.
+//------------------------------------------------------------------------------
+#if defined(__SSE__) || (defined(__ARM_NEON) && defined(__aarch64__))
+#define VECTOR3_SIMD (1)
+#else
+#define VECTOR3_SIMD (0)
+#endif
+
+#if VECTOR3_SIMD
+#if defined(__clang__)
+#define VECTOR3_SHUFFLE(v, a, b, c, d) __builtin_shufflevector(v, v, a, b, c, d)
+#else
+#define VECTOR3_SHUFFLE(v, a, b, c, d) __builtin_shuffle(v, (Vector3::Lanei){a, b, c, d})
+#endif
+#endif
+
+class alignas(16) Vector3 {
 public:
   float x;
   float y;
   float z;
+  float w;  // padding lane, always 0
 
 public:
-  Vector3() {}
+  constexpr Vector3() : x(0), y(0), z(0), w(0) {}
 
-  
-  Vector3( float xx, float yy, float zz ) {
-    x = xx;
-    y = yy;
-    z = zz;
-  }
 
+  constexpr Vector3( float xx, float yy, float zz ) : x(xx), y(yy), z(zz), w(0) {}
 
-  Vector3( float v[ 3 ] ) {
-    x = v[ 0 ];
-    y = v[ 1 ];
-    z = v[ 2 ];
-  }
 
-  
-  ~Vector3() {};
+  Vector3( const float v[ 3 ] ) : x(v[0]), y(v[1]), z(v[2]), w(0) {}
 
 
   Vector3 &MakeZero() {
@@ -58,131 +71,70 @@ public:
   }
 
 
-  Vector3 operator + () const { // Unary negation
-    return Vector3(*this);
+  Vector3 operator + () const { // Unary plus
+    return *this;
   }
 
 
   Vector3 operator - () const { // Unary negation
+#if VECTOR3_SIMD
+    return Store( -Load() );
+#else
     return Vector3( -x, -y, -z );
+#endif
   }
 
 
-  Vector3 operator *= ( float v ) { // assigned multiply by a float
-    x *= v;
-    y *= v;
-    z *= v;
-
-    return *this;
+  Vector3 &operator *= ( float v ) { // assigned multiply by a float
+    return *this = *this * v;
   }
 
 
-  Vector3 operator /= ( float t ) { // assigned division by a float
-    float v;
-
-    if( t == 0.0f )
-      v = 0;
-    else
-      v = 1.0f / t;
-
-    x *= v;
-    y *= v;
-    z *= v;
-
-    return *this;
+  // No check for 0, callers test the length first where it matters
+  Vector3 &operator /= ( float t ) { // assigned division by a float
+    return *this = *this * ( 1.0f / t );
   }
 
 
-  Vector3 operator -= ( const Vector3 &v ) { // assigned subtraction
-    x -= v.x;
-    y -= v.y;
-    z -= v.z;
-
-    return *this;
+  Vector3 &operator -= ( const Vector3 &v ) { // assigned subtraction
+    return *this = *this - v;
   }
 
 
-  Vector3 operator += ( const Vector3 &v ) { // assigned addition
-    x += v.x;
-    y += v.y;
-    z += v.z;
-
-    return *this;
+  Vector3 &operator += ( const Vector3 &v ) { // assigned addition
+    return *this = *this + v;
   }
 
 
-  Vector3 operator *= ( const Vector3 &v ) { // assigned mult.
-    x *= v.x;
-    y *= v.y;
-    z *= v.z;
-
-    return *this;
+  Vector3 &operator *= ( const Vector3 &v ) { // assigned mult.
+    return *this = *this * v;
   }
 
 
-  Vector3 operator ^= ( const Vector3 &v ) { // assigned cross product
-    float nx, ny, nz;
-    
-    nx = ( y * v.z - z * v.y );
-    ny =-( x * v.z - z * v.x );
-    nz = ( x * v.y - y * v.x );
-    x = nx;
-    y = ny;
-    z = nz;
-
-    return *this;
+  Vector3 &operator ^= ( const Vector3 &v ) { // assigned cross product
+    return *this = *this ^ v;
   }
 
-/*
-  bool operator == ( const Vector3 &v ) const {
-    return ( abs( x - v.x ) < 0.01f &&
-             abs( y - v.y ) < 0.01f &&
-             abs( z - v.z ) < 0.01f );
-  }*/
-
-/*
-  bool operator != ( const Vector3 &v ) const {
-    return ( abs( x - v.x ) > 0.01f ||
-             abs( y - v.y ) > 0.01f ||
-             abs( z - v.z ) > 0.01f );
-  }*/
-
 
   // METHODS
   float Length() const {
-    return (float)sqrt( x*x+y*y+z*z );
+    return sqrtf( LengthSquared() );
   }
 
 
   float LengthSquared() const {
-    return x*x+y*y+z*z;
+    return *this | *this;
   }
 
 
   void Normalize() {
-    float len, iLen;
-
-    len = Length();
-    if( !len ) iLen = 0;
-    else iLen = 1.0f / len;
-
-    x *= iLen;
-    y *= iLen;
-    z *= iLen;
+    NormalizeLength();
   }
 
 
   float NormalizeLength() {
-    float len, iLen;
-
-    len = Length();
-    if( !len ) iLen = 0;
-    else iLen = 1.0f / len;
-
-    x *= iLen;
-    y *= iLen;
-    z *= iLen;
-
+    float len = Length();
+    *this *= ( len > 0 ) ? 1.0f / len : 0.0f;
     return len;
   }
 
@@ -209,86 +161,103 @@ public:
 
   // Interpolate between *this and v
   void Interpolate( const Vector3 &v, float a ) {
-    float b( 1.0f - a );
-
-    x = b * x + a * v.x;
-    y = b * y + a * v.y;
-    z = b * z + a * v.z;
+    *this = *this * ( 1.0f - a ) + v * a;
   }
 
 
   float operator | ( const Vector3 &v ) const { // Dot product
+#if VECTOR3_SIMD
+    Lanes p = Load() * v.Load();
+    return p[0] + p[1] + p[2];
+#else
     return x * v.x + y * v.y + z * v.z;
+#endif
   }
 
 
+  // No check for 0, as /=
   Vector3 operator / ( float t ) const { // vector / float
-    if( t == 0.0f )
-      return Vector3( 0, 0, 0 );
-
-    float s( 1.0f / t );
-
-    return Vector3( x * s, y * s, z * s );
+    return *this * ( 1.0f / t );
   }
 
 
   Vector3 operator + ( const Vector3 &b ) const { // vector + vector
+#if VECTOR3_SIMD
+    return Store( Load() + b.Load() );
+#else
     return Vector3( x + b.x, y + b.y, z + b.z );
+#endif
   }
 
 
   Vector3 operator - ( const Vector3 &b ) const { // vector - vector
+#if VECTOR3_SIMD
+    return Store( Load() - b.Load() );
+#else
     return Vector3( x - b.x, y - b.y, z - b.z );
+#endif
   }
 
 
   Vector3 operator * ( const Vector3 &b ) const { // vector * vector
+#if VECTOR3_SIMD
+    return Store( Load() * b.Load() );
+#else
     return Vector3( x * b.x, y * b.y, z * b.z );
+#endif
   }
 
 
   Vector3 operator ^ ( const Vector3 &b ) const { // cross(a,b)
-    float nx, ny, nz;
-
-    nx = y * b.z - z * b.y;
-    ny = z * b.x - x * b.z;
-    nz = x * b.y - y * b.x;
-
-    return Vector3( nx, ny, nz );
+#if VECTOR3_SIMD
+    Lanes a = Load();
+    Lanes c = b.Load();
+    Lanes a_yzx = VECTOR3_SHUFFLE( a, 1, 2, 0, 3 );
+    Lanes c_yzx = VECTOR3_SHUFFLE( c, 1, 2, 0, 3 );
+    Lanes r = a * c_yzx - a_yzx * c;  // cross product in zxy order
+    return Store( VECTOR3_SHUFFLE( r, 1, 2, 0, 3 ) );
+#else
+    return Vector3( y * b.z - z * b.y,
+                    z * b.x - x * b.z,
+                    x * b.y - y * b.x );
+#endif
   }
 
 
   Vector3 operator * ( float s ) const {
+#if VECTOR3_SIMD
+    // 0 in the last lane keeps w at 0 even for s = inf
+    Lanes m = { s, s, s, 0 };
+    return Store( Load() * m );
+#else
     return Vector3( x * s, y * s, z * s );
+#endif
   }
 
-/*
-  void Rotate( Vector3 &axis, float angle ) {
-    float sa = (float)sin( angle );
-    float ca = (float)cos( angle );
-    Vector3 axis2( axis );
-    float m[9];
-
-    axis2.Normalize();
-
-    m[ 0 ] = ca + (1 - ca) * axis2.x * axis2.x;
-    m[ 1 ] = (1 - ca) * axis2.x * axis2.y - sa * axis2.z;
-    m[ 2 ] = (1 - ca) * axis2.z * axis2.x + sa * axis2.y;
-    m[ 3 ] = (1 - ca) * axis2.x * axis2.y + sa * axis2.z;
-    m[ 4 ] = ca + (1 - ca) * axis2.y * axis2.y;
-    m[ 5 ] = (1 - ca) * axis2.y * axis2.z - sa * axis2.x;
-    m[ 6 ] = (1 - ca) * axis2.z * axis2.x - sa * axis2.y;
-    m[ 7 ] = (1 - ca) * axis2.y * axis2.z + sa * axis2.x;
-    m[ 8 ] = ca + (1 - ca) * axis2.z * axis2.z;
-
-    Vector3 src( *this );
-
-    x = m[0] * src.x + m[1] * src.y + m[2] * src.z;
-    y = m[3] * src.x + m[4] * src.y + m[5] * src.z;
-    z = m[6] * src.x + m[7] * src.y + m[8] * src.z;
-  }*/
+#if VECTOR3_SIMD
+  typedef float Lanes __attribute__((vector_size(16)));
+  typedef int Lanei __attribute__((vector_size(16)));
+
+private:
+  Lanes Load() const {
+    Lanes v;
+    __builtin_memcpy( &v, this, sizeof(v) );
+    return v;
+  }
+
+
+  static Vector3 Store( Lanes v ) {
+    Vector3 r;
+    // fine for a trivially copyable type, the cast just tells GCC so
+    __builtin_memcpy( static_cast<void *>( &r ), &v, sizeof(v) );
+    return r;
+  }
+#endif
 };
 
+static_assert( std::is_trivially_copyable<Vector3>::value, "Vector3 should be trivially copyable" );
+static_assert( sizeof(Vector3) == 4 * sizeof(float), "Vector3 should be one 4 float register" );
+
 
 
 /**
@@ -0,0 +1,68 @@
+#ifndef WEEDASSIGNER_H
+#define WEEDASSIGNER_H
+//------------------------------------------------------------------------------
+// Splitting the weeds in front of the implement between its delta arms.
+//
+// Every arm sees the same weeds, each from where it is mounted.  assign()
+// takes the weeds in the order they leave (earliest deadline first) and gives
+// each to the arm that can finish it soonest, timed by that arm's own
+// WeedScheduler from where its previous weed leaves it.  A weed goes to one
+// arm at most, and never to an arm while another arm has a weed within the
+// clearance of it: the weeds ride the ground together, so arms working on
+// weeds that far apart stay that far apart.
+//------------------------------------------------------------------------------
+
+#include "weedScheduler.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * An arm as it is now
+ */
+struct ArmSlot {
+  Vector3 mount;            // delta frame origin in the tracker frame (cm)
+  float angles[NUM_AXIES];  // where its current move leaves it (degrees)
+  float free;               // until it is done with its current weed (s)
+  int held;                 // weed it is working on, -1 if none
+  Vector3 held_position;    // and where that weed is now, tracker frame (cm)
+};
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class WeedAssigner {
+public:
+  /**
+   * @input arms the timing and workspace of each arm, in its own frame
+   * @input clearance least distance between the weeds of two arms (cm)
+   */
+  WeedAssigner(const std::vector<const WeedScheduler *> &arms, float clearance);
+
+  /**
+   * @input slots each arm now, in the order of the schedulers
+   * @input weeds in the tracker frame
+   * @return the arm for each weed, -1 if none can finish it
+   */
+  const std::vector<int> &assign(const std::vector<ArmSlot> &slots, const std::vector<WeedCandidate> &weeds);
+
+  // Weed ids given to an arm by the last assign(), in the order it gets to them
+  const std::vector<int> &order(int arm) const { return orders_[arm]; }
+
+private:
+  bool clear(int arm, const Vector3 &position) const;
+
+  std::vector<const WeedScheduler *> arms_;
+  float clearance_;
+
+  std::vector<int> assigned_;
+  std::vector<std::vector<int> > orders_;
+  // where each arm has weeds, tracker frame
+  std::vector<std::vector<Vector3> > claimed_;
+};
+
+#endif
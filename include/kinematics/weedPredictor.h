@@ -0,0 +1,81 @@
+#ifndef WEEDPREDICTOR_H
+#define WEEDPREDICTOR_H
+//------------------------------------------------------------------------------
+// Motion predictor for one tracked weed.
+//
+// Constant velocity Kalman filter on x and y (tracker frame, cm), fed by the
+// track's positions at their capture times and by the ground speed from the
+// tracker's velocity topic.  Lets the governor aim where the weed will be when
+// the arm gets there instead of where it was when the camera saw it.  Height
+// is taken as it was last seen.
+//------------------------------------------------------------------------------
+
+#include "vector3.h"
+
+/**
+ * Filter noise, as standard deviations
+ */
+struct WeedPredictorNoise {
+  float position;  // of a tracked position (cm)
+  float velocity;  // of the velocity topic (cm/s)
+  float accel;     // how far the weed strays from constant velocity (cm/s^2)
+};
+
+class WeedPredictor {
+public:
+  explicit WeedPredictor(const WeedPredictorNoise &noise = WeedPredictorNoise{1.0f, 2.0f, 10.0f});
+
+  void reset() { valid_ = false; }
+  bool valid() const { return valid_; }
+
+  /**
+   * Tracked position.  Positions not newer than the last one are dropped,
+   * so the same frame fetched twice counts once.
+   * @input t capture time (s)
+   */
+  void updatePosition(double t, const Vector3 &position);
+
+  /**
+   * Ground speed along y (the direction of travel) from the velocity topic.
+   * Ignored until the first position.  Taken as the velocity at the time of
+   * the last position, whatever its own stamp.  Readings not newer than the
+   * last one fused are dropped, so the same reading passed on with every
+   * position counts once.
+   * @input t time of the reading (s), only to tell readings apart
+   */
+  void updateVelocity(double t, float velocityY);
+
+  /**
+   * Position at time t (s); the last state if t is before it
+   */
+  Vector3 predict(double t) const;
+
+  Vector3 velocity() const { return Vector3(x_.v, y_.v, 0); }
+  // of the velocity along y, (cm/s)^2
+  float velocityVariance() const { return y_.vv; }
+  double time() const { return t_; }
+
+private:
+  // position and velocity along one axis, with their covariance
+  struct Axis {
+    float p, v;
+    float pp, pv, vv;
+
+    void init(float position, float positionVar, float velocityVar);
+    void predict(float dt, float accelVar);
+    void observePosition(float z, float var);
+    void observeVelocity(float z, float var);
+  };
+
+  void advance(double t);
+
+  WeedPredictorNoise noise_;
+  bool valid_;
+  double t_;
+  // of the last velocity reading fused
+  double velocity_t_;
+  Axis x_, y_;
+  float z_;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef WEEDSCHEDULER_H
+#define WEEDSCHEDULER_H
+//------------------------------------------------------------------------------
+// Lookahead ordering of the weeds in front of the arm.
+//
+// Weeds ride the ground past the arm and are lost once they leave the
+// workspace, so the order they are visited in decides how many get done.
+// plan() searches the orders of the next few weeds, timing every move with
+// the joint motion profile and every weed with its dwell, and keeps the one
+// that finishes the most weeds before they leave (then the soonest).  The
+// last plan seeds the next search so re-planning on every detection is cheap.
+//------------------------------------------------------------------------------
+
+#include "deltaTrajectory.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * A weed as it is now, in the tracker frame
+ */
+struct WeedCandidate {
+  int id;
+  Vector3 position;  // cm
+  Vector3 velocity;  // cm/s
+};
+
+struct WeedSchedulerConfig {
+  DeltaJointLimits limits;  // shoulders, for timing moves
+  float dwell;              // time spent on each weed (s)
+  float soil_offset;        // tracker to delta frame, see deltaFrame.h (cm)
+  float min_angle;          // shoulder limits (degrees)
+  float max_angle;
+  float x_min, x_max;       // workspace in the tracker frame (cm); weeds
+  float y_min, y_max;       // leave it past y_min
+  int window;               // weeds considered, those leaving first
+  int horizon;              // weeds ordered ahead
+};
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class WeedScheduler {
+public:
+  WeedScheduler(const DeltaKinematics &kinematics, const WeedSchedulerConfig &config);
+
+  /**
+   * Order the weeds from where the arm is now.
+   * @input angles shoulder angles now (degrees)
+   * @return ids to visit, first one next; empty if none can be finished
+   */
+  const std::vector<int> &plan(const float angles[NUM_AXIES], const std::vector<WeedCandidate> &weeds);
+
+  const std::vector<int> &order() const { return order_; }
+  // Time the planned order takes, from now to the end of the last dwell (s)
+  float finish() const { return finish_; }
+  // Search nodes expanded by the last plan()
+  int expanded() const { return expanded_; }
+
+  /**
+   * Time to travel between two poses (s)
+   */
+  float travelTime(const float from[NUM_AXIES], const float to[NUM_AXIES]) const;
+
+  /**
+   * Visit weed w after being at 'from' at time t.
+   * @output angles pose at the weed
+   * @output done time the dwell ends
+   * @return false if it can't be finished inside the workspace
+   */
+  bool visit(const WeedCandidate &w, const float from[NUM_AXIES], float t,
+             float angles[NUM_AXIES], float &done) const;
+
+private:
+  void search(int depth, int count, float t, const float from[NUM_AXIES]);
+
+  const DeltaKinematics &kinematics_;
+  WeedSchedulerConfig config_;
+
+  std::vector<WeedCandidate> window_;
+  std::vector<bool> used_;
+  std::vector<int> path_;
+
+  std::vector<int> order_;
+  int best_count_;
+  float finish_;
+  int expanded_;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+//------------------------------------------------------------------------------
+// Framed commands waiting to go out on the serial link.
+//
+// The link is slower than the governor can send motor targets while it is
+// tracking a weed, and a target is stale as soon as a newer one exists.  A
+// latest-wins frame (a motor target) that is pushed while an earlier one is
+// still waiting replaces it, so the arm heads for the freshest target and
+// never works through a backlog.  The newer frame goes in at the back like
+// any other: nothing ever overtakes a frame pushed before it, and every other
+// frame (config, end effector, calibration) keeps first in, first out order.
+//------------------------------------------------------------------------------
+
+#include "serialFrame.h"
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+struct QueuedFrame {
+  uint8_t bytes[SERIAL_FRAME_MAX_SIZE];
+  size_t size;
+  bool latest_wins;
+};
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class CommandQueue {
+public:
+  /**
+   * @input capacity most frames waiting at once
+   */
+  explicit CommandQueue(size_t capacity);
+
+  /**
+   * @input latest_wins drops the latest-wins frame already waiting, if any,
+   *                    and goes in at the back
+   * @return false if the queue is full or the frame too big (it is not added)
+   */
+  bool push(const uint8_t *frame, size_t size, bool latest_wins);
+
+  /**
+   * @return false if the queue is empty
+   */
+  bool pop(QueuedFrame &frame);
+
+  size_t size() const { return frames_.size(); }
+  bool empty() const { return frames_.empty(); }
+
+  unsigned long sent() const { return sent_; }            // popped
+  unsigned long coalesced() const { return coalesced_; }  // replaced before they were popped
+  unsigned long dropped() const { return dropped_; }      // not pushed, queue full
+
+private:
+  size_t capacity_;
+  std::deque<QueuedFrame> frames_;
+
+  unsigned long sent_, coalesced_, dropped_;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef COMMANDWINDOW_H
+#define COMMANDWINDOW_H
+//------------------------------------------------------------------------------
+// Commands in flight to the Teensy, and the acks that resolve them.
+//
+// The serial node numbers every command it writes and the Teensy acks each
+// with that number and the command type, so up to a window's worth can be
+// out at once and each ack resolves its own.  A command not acked by when it
+// should be done (plus the ack timeout), or nacked, is handed back to be
+// written again, up to a number of retries, unless a later latest-wins
+// command (a motor target) replaced it.  An ack can beat the write's reply
+// with the sequence number; it is kept a while for the command to claim.
+//
+// Not thread safe: the governor holds its own lock around every call.  Times
+// are in seconds on any one clock.
+//------------------------------------------------------------------------------
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+// Anything but pending or acked is a failure, saying why, or not known to
+// have worked
+enum CommandStatus { CMD_PENDING, CMD_ACKED, CMD_NACKED, CMD_TIMED_OUT, CMD_REPLACED, CMD_NEVER_SENT,
+                     CMD_EXPIRED };
+
+// A command to write again
+struct CommandResend {
+  unsigned id;
+  std::string bytes;
+  // otherwise timed out
+  bool nacked;
+};
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+/**
+ * @return what happened to the command, for the log
+ */
+const char *command_status_name(CommandStatus status);
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class CommandWindow {
+public:
+  /**
+   * @input size most commands in flight at once
+   * @input retries times a command is written again before it is given up on
+   * @input ack_timeout seconds past when it should be done before a command
+   *                    is written again
+   */
+  CommandWindow(size_t size, int retries, double ack_timeout);
+
+  /**
+   * Make room for another command, dropping a replaced one if the window is
+   * full
+   * @return false if it is full of commands still wanted
+   */
+  bool makeRoom();
+
+  /**
+   * A command just written
+   * @input sequence the serial node's number for it
+   * @input type its command type, acks carry it back
+   * @input bytes what was written, to write it again
+   * @input latest_wins replaces the latest-wins commands in flight
+   * @input expect seconds the Teensy takes to do it, before the ack is due
+   * @return its id for status(), never 0
+   */
+  unsigned add(uint8_t sequence, int type, const std::string &bytes, bool latest_wins, double now,
+               double expect);
+
+  /**
+   * An ack from the Teensy, success or not
+   * @return false if no command in flight matches it (yet)
+   */
+  bool ack(uint8_t sequence, int type, bool success, double now);
+
+  /**
+   * Give up on or drop the commands that are overdue or nacked
+   * @output resend the rest of them, to write again and pass to resent()
+   * @output failed ids of those given up on after all their retries, nacked
+   *                or timed out the last time
+   */
+  void due(double now, std::vector<CommandResend> &resend, std::vector<unsigned> &failed);
+
+  /**
+   * A command from due() written again.  Its ack may already be in.
+   * @input written false if the write failed, it times out again
+   */
+  void resent(unsigned id, bool written, uint8_t sequence, double now);
+
+  /**
+   * Only how the last few commands ended is kept
+   * @return CMD_NEVER_SENT for an id never handed out, CMD_EXPIRED for one
+   *         that ended before the last few, acked or not
+   */
+  CommandStatus status(unsigned id) const;
+
+  /**
+   * @return when the next command is due to be written again, no later than
+   *         now plus the ack timeout
+   */
+  double nextDue(double now) const;
+
+  size_t size() const { return in_flight_.size(); }
+
+private:
+  struct Pending {
+    unsigned id;
+    uint8_t sequence;
+    int type;
+    std::string bytes;
+    double sent, expect;
+    int retries;
+    bool latest_wins, nacked, superseded;
+  };
+
+  struct UnmatchedAck {
+    uint8_t sequence;
+    int type;
+    bool success;
+    double received;
+  };
+
+  std::deque<Pending>::iterator finish(std::deque<Pending>::iterator cmd, CommandStatus status);
+  void resolve(std::deque<Pending>::iterator cmd, bool success);
+  void claimAck(std::deque<Pending>::iterator cmd, double now);
+
+  size_t size_;
+  int retries_;
+  double ack_timeout_;
+
+  unsigned next_id_;
+  // oldest first
+  std::deque<Pending> in_flight_;
+  // How the last few ended
+  std::deque<std::pair<unsigned, CommandStatus> > finished_;
+  std::deque<UnmatchedAck> unmatched_;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SERIALFRAME_H
+#define SERIALFRAME_H
+//------------------------------------------------------------------------------
+// Framing for the packed structs on the serial link to the Teensy.
+//
+//   sync (0xA5) | length | sequence | payload (length bytes) | CRC16 (LE)
+//
+// The CRC is CRC-16/CCITT-FALSE over length, sequence and payload.  Payload
+// bytes can take any value; a sync byte inside a payload that gets taken for
+// the start of a frame fails the CRC and the decoder looks again from the
+// byte after it, so it finds its way back to the frames after any corruption
+// or dropped bytes.  The Teensy firmware frames its side the same way.
+//------------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+
+const uint8_t SERIAL_FRAME_SYNC = 0xA5;
+const size_t SERIAL_FRAME_HEADER = 3;   // sync, length, sequence
+const size_t SERIAL_FRAME_TRAILER = 2;  // CRC16
+const size_t SERIAL_FRAME_OVERHEAD = SERIAL_FRAME_HEADER + SERIAL_FRAME_TRAILER;
+const size_t SERIAL_FRAME_MAX_PAYLOAD = 64;
+const size_t SERIAL_FRAME_MAX_SIZE = SERIAL_FRAME_MAX_PAYLOAD + SERIAL_FRAME_OVERHEAD;
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+/**
+ * A decoded frame.  The payload points into the caller's buffer or the
+ * decoder's, and is good until the next call to the decoder.
+ */
+struct SerialFrame {
+  uint8_t sequence;
+  uint8_t length;
+  const uint8_t *payload;
+};
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+/**
+ * CRC-16/CCITT-FALSE, continued from crc
+ */
+uint16_t serial_crc16(const uint8_t *data, size_t n, uint16_t crc = 0xFFFF);
+
+/**
+ * Frame a payload.
+ * @output out at least length + SERIAL_FRAME_OVERHEAD bytes
+ * @return bytes written, 0 if the payload is too long
+ */
+size_t serial_frame_encode(uint8_t sequence, const void *payload, size_t length, uint8_t *out);
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+/**
+ * Incremental decoder for a byte stream, fed in whatever chunks it is read
+ * in.  Frames that lie whole in a chunk are checked where they are; only a
+ * frame split across chunks is put together in the decoder's own buffer.
+ * Nothing is allocated.
+ */
+class SerialFrameDecoder {
+public:
+  SerialFrameDecoder();
+
+  /**
+   * Decode up to the end of the next frame.  Call again with the rest of the
+   * chunk until it has all been used.
+   * @output frame set if complete
+   * @output complete whether a frame was decoded
+   * @return bytes of data used
+   */
+  size_t decode(const uint8_t *data, size_t n, SerialFrame &frame, bool &complete);
+
+  // Drop any partial frame
+  void reset();
+
+  unsigned long frames() const { return frames_; }
+  unsigned long rejected() const { return rejected_; }    // bad length or CRC
+  unsigned long skipped() const { return skipped_; }      // bytes outside any good frame
+
+private:
+  void resync();
+
+  uint8_t buf_[SERIAL_FRAME_MAX_SIZE];
+  size_t have_;
+  // size of the frame handed out of buf_, dropped on the next call
+  size_t emitted_;
+
+  unsigned long frames_, rejected_, skipped_;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SERIALIOLOOP_H
+#define SERIALIOLOOP_H
+//------------------------------------------------------------------------------
+// Non-blocking I/O on the serial port, one thread driving both directions.
+//
+// The port is opened raw and non-blocking and watched with epoll along with
+// an eventfd (commands queued, or stop) and a timerfd.  Whatever comes in is
+// handed to the read handler as soon as the port is readable.  Commands go
+// out of a CommandQueue one frame at a time, written as the port becomes
+// writable; once a frame is written the next is only taken off the queue
+// when the timerfd says the bytes still in the driver's buffer are on the
+// wire.  That keeps commands waiting in the queue, where a newer motor target
+// can still replace them, and never blocks reads behind writes.
+//------------------------------------------------------------------------------
+
+#include "commandQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+/**
+ * Open a tty raw 8N1, no flow control, non-blocking
+ * @input baud one of the standard rates from 9600 to 921600
+ * @return the fd, -1 on failure (errno says why)
+ */
+int serial_port_open(const char *path, int baud);
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+class SerialIoLoop {
+public:
+  // Called on the I/O thread with each chunk read
+  typedef std::function<void(const uint8_t *data, size_t n)> ReadHandler;
+
+  /**
+   * @input fd non-blocking, left open by the loop
+   * @input baud to time the bytes on the wire
+   * @input queue_capacity most commands waiting at once
+   */
+  SerialIoLoop(int fd, int baud, size_t queue_capacity, const ReadHandler &on_read);
+  ~SerialIoLoop();
+
+  // Whether the epoll, event and timer fds were all made
+  bool ok() const { return epoll_fd_ >= 0 && event_fd_ >= 0 && timer_fd_ >= 0; }
+
+  /**
+   * Any thread.  Queue a frame to be written, see CommandQueue::push()
+   */
+  bool send(const uint8_t *frame, size_t size, bool latest_wins);
+
+  /**
+   * Any thread.  Make run() return
+   */
+  void stop();
+
+  /**
+   * The I/O thread.  Runs until stop()
+   * @return false if the port failed (errno says why)
+   */
+  bool run();
+
+  // Any thread
+  unsigned long sent() const;
+  unsigned long coalesced() const;
+  unsigned long dropped() const;
+
+private:
+  void wake();
+  bool readPort();
+  bool writePort();
+  bool nextFrame();
+  bool drainAfterWrite();
+  bool watchWritable(bool writable);
+
+  int fd_;
+  double byte_time_;
+  ReadHandler on_read_;
+  int epoll_fd_, event_fd_, timer_fd_;
+  std::atomic<bool> stop_;
+
+  mutable std::mutex queue_mutex_;
+  CommandQueue queue_;
+
+  // Frame being written, and how much of it has gone (I/O thread only)
+  QueuedFrame frame_;
+  size_t written_;
+  bool writing_, draining_, watching_out_;
+};
+
+#endif
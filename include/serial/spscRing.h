@@ -0,0 +1,62 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+//------------------------------------------------------------------------------
+// Lock free ring buffer for one producer thread and one consumer thread.
+//
+// The producer only ever writes the head and the consumer the tail, each
+// published with a release store and read with an acquire load, so an item
+// is written in full before the other side can see it.  The counters run
+// freely and are masked into the array, so all N slots are usable.
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <stddef.h>
+
+//------------------------------------------------------------------------------
+// CLASS
+//------------------------------------------------------------------------------
+
+template <class T, size_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+  SpscRing() : head_(0), tail_(0) {}
+
+  /**
+   * Producer only.
+   * @return false if the ring is full (the item is not added)
+   */
+  bool push(const T &item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == N) return false;
+    items_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Consumer only.
+   * @return false if the ring is empty
+   */
+  bool pop(T &item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) return false;
+    item = items_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Either side; only a snapshot while the other side is running
+  size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  T items_[N];
+  // each on its own cache line so the two threads don't contend for one
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+};
+
+#endif
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+// Arm state machine, see armCycle.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "armCycle.h"
+
+#include <algorithm>
+#include <limits>
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+const char *arm_state_name(ArmState state) {
+  switch (state) {
+    case ARM_IDLE: return "idle";
+    case ARM_APPROACH: return "approach";
+    case ARM_DWELL: return "dwell";
+    case ARM_RETRACT: return "retract";
+  }
+  return "unknown";
+}
+
+ArmCycle::ArmCycle(const ArmCycleConfig &config)
+  : config_(config), state_(ARM_IDLE), state_start_(0), move_sent_(false), arrival_(0) {}
+
+void ArmCycle::enter(ArmState state, double now) {
+  if (state == ARM_APPROACH) move_sent_ = false;
+  state_ = state;
+  state_start_ = now;
+}
+
+void ArmCycle::moved(double arrival) {
+  move_sent_ = true;
+  arrival_ = arrival;
+}
+
+/**
+ * The motors are done with the move once it is acked, or should be by the
+ * planned arrival.  With nothing sent there is no arrival to wait for.
+ */
+ArmState ArmCycle::due(double now, bool arrived) const {
+  switch (state_) {
+    case ARM_APPROACH:
+      if (move_sent_ ? arrived || now >= arrival_ : now - state_start_ >= config_.no_move_wait) return ARM_DWELL;
+      break;
+    case ARM_DWELL:
+      if (now - state_start_ >= config_.dwell) return ARM_IDLE;
+      break;
+    case ARM_RETRACT:
+      if (arrived || now >= arrival_) return ARM_IDLE;
+      break;
+    case ARM_IDLE:
+      break;
+  }
+  return state_;
+}
+
+double ArmCycle::spinupIn(double now) const {
+  if (!working() || !move_sent_) return std::numeric_limits<double>::infinity();
+  return arrival_ - now - config_.spinup;
+}
+
+double ArmCycle::dwellLeft(double now) const {
+  if (state_ != ARM_DWELL) return 0;
+  return std::max(0.0, config_.dwell - (now - state_start_));
+}
+
+double ArmCycle::timeToFree(double now) const {
+  double left = 0;
+  switch (state_) {
+    case ARM_APPROACH:
+      left = (move_sent_ ? arrival_ - now : 0) + config_.dwell;
+      break;
+    case ARM_DWELL:
+      left = config_.dwell - (now - state_start_);
+      break;
+    case ARM_RETRACT:
+      left = arrival_ - now;
+      break;
+    case ARM_IDLE:
+      break;
+  }
+  return std::max(0.0, left);
+}
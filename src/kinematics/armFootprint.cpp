@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+// Camera occlusion by the arm, see armFootprint.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "armFootprint.h"
+#include "deltaFrame.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+
+// Parts of the arm closer than this below the camera are out of its view (cm)
+static const float MIN_DEPTH = 1.0f;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+ArmFootprint::ArmFootprint(const DeltaKinematics &kinematics, const Vector3 &mount, float soilOffset,
+                           const Vector3 &camera, float linkRadius)
+  : kinematics_(kinematics), mount_(mount.x, mount.y, 0), soil_offset_(soilOffset),
+    camera_(camera), link_radius_(linkRadius) {}
+
+Vector3 ArmFootprint::toTracker(const Vector3 &p) const {
+  return tracker_frame_position(p, soil_offset_) + mount_;
+}
+
+/**
+ * The link from a to b, cut off where it comes level with the camera, cast
+ * onto the soil along the rays through the camera
+ */
+void ArmFootprint::addShadow(const Vector3 &a, const Vector3 &b, std::vector<GroundRect> &shadows) const {
+  float top = camera_.z - MIN_DEPTH;
+  Vector3 p = a, q = b;
+  if (p.z > q.z) std::swap(p, q);
+  if (p.z > top) return;
+  if (q.z > top) q = p + (q - p) * ((top - p.z) / (q.z - p.z));
+
+  float scaleP = camera_.z / (camera_.z - p.z);
+  float scaleQ = camera_.z / (camera_.z - q.z);
+  Vector3 sp = camera_ + (p - camera_) * scaleP;
+  Vector3 sq = camera_ + (q - camera_) * scaleQ;
+  float r = link_radius_ * std::max(scaleP, scaleQ);
+
+  GroundRect shadow = {std::min(sp.x, sq.x) - r, std::max(sp.x, sq.x) + r,
+                       std::min(sp.y, sq.y) - r, std::max(sp.y, sq.y) + r};
+  shadows.push_back(shadow);
+}
+
+bool ArmFootprint::project(const float angles[NUM_AXIES], std::vector<GroundRect> &shadows) const {
+  shadows.clear();
+
+  Vector3 tool;
+  if (!kinematics_.forward(angles, tool)) return false;
+  Vector3 effector = tool - kinematics_.toolOffset();
+  addShadow(toTracker(effector), toTracker(tool), shadows);
+
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    Vector3 shoulder = toTracker(kinematics_.arm(i).shoulder);
+    Vector3 elbow = toTracker(kinematics_.elbowAt(i, angles[i]));
+    Vector3 wrist = toTracker(effector + kinematics_.arm(i).wrist_relative);
+    addShadow(shoulder, elbow, shadows);
+    addShadow(elbow, wrist, shadows);
+  }
+  return true;
+}
+
+bool ArmFootprint::occludes(const float angles[NUM_AXIES], const std::vector<GroundRect> &regions) const {
+  std::vector<GroundRect> shadows;
+  if (!project(angles, shadows)) return true;
+
+  for (size_t i = 0; i < shadows.size(); ++i) {
+    for (size_t j = 0; j < regions.size(); ++j) {
+      if (shadows[i].overlaps(regions[j])) return true;
+    }
+  }
+  return false;
+}
+
+bool ArmFootprint::clearingPose(float x, float y, float zMin, float zMax, float step, float maxAngle,
+                                const std::vector<GroundRect> &regions, float angles[NUM_AXIES]) const {
+  if (step <= 0) return false;
+
+  for (float z = zMin; z <= zMax; z += step) {
+    Vector3 target = delta_frame_position(x - mount_.x, y - mount_.y, z, soil_offset_);
+    if (!kinematics_.solve(target, angles)) continue;
+
+    bool inLimits = true;
+    for (int i = 0; i < NUM_AXIES; ++i) {
+      if (angles[i] < 0 || angles[i] > maxAngle) inLimits = false;
+    }
+    if (inLimits && !occludes(angles, regions)) return true;
+  }
+  return false;
+}
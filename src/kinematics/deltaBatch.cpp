@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+// Batched inverse kinematics, see deltaBatch.h
+//
+// Uses GCC vector extensions so the same code becomes SSE/AVX on the desktop
+// and NEON on the Jetson.  Only sqrt needs a per-ISA intrinsic; atan2 is a
+// polynomial since libm has no vector version we can rely on.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaBatch.h"
+#include "vector3.h"
+
+#include <math.h>
+
+#if defined(__SSE__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#if defined(__AVX__)
+#define BATCH_WIDTH (8)
+#else
+#define BATCH_WIDTH (4)
+#endif
+
+typedef float vfloat __attribute__((vector_size(BATCH_WIDTH * sizeof(float))));
+
+static const float BATCH_PI      = 3.14159265f;
+static const float BATCH_HALF_PI = 1.57079633f;
+static const float BATCH_RAD2DEG = 57.2957795f;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+static inline vfloat vsplat(float f) {
+  vfloat v;
+  for (int i = 0; i < BATCH_WIDTH; ++i) v[i] = f;
+  return v;
+}
+
+static inline vfloat vsqrt(vfloat v) {
+#if defined(__AVX__)
+  return (vfloat)_mm256_sqrt_ps((__m256)v);
+#elif defined(__SSE__)
+  return (vfloat)_mm_sqrt_ps((__m128)v);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return (vfloat)vsqrtq_f32((float32x4_t)v);
+#else
+  vfloat r;
+  for (int i = 0; i < BATCH_WIDTH; ++i) r[i] = sqrtf(v[i]);
+  return r;
+#endif
+}
+
+static inline vfloat vabs(vfloat v) {
+  return v < 0 ? -v : v;
+}
+
+/**
+ * atan2 for a whole register.  Max error is ~2e-6 rad, ~1.1e-4 deg (well
+ * under the one degree resolution of the motor commands, see DeltaBatchTest).
+ * NaN in, NaN out.
+ */
+static inline vfloat vatan2(vfloat y, vfloat x) {
+  vfloat ax = vabs(x);
+  vfloat ay = vabs(y);
+  vfloat mx = ax > ay ? ax : ay;
+  vfloat mn = ax > ay ? ay : ax;
+  // avoid 0/0 at the origin, atan2(0,0) is 0 anyway
+  mx = mx > 0 ? mx : vsplat(1.0f);
+
+  vfloat a = mn / mx;
+  vfloat s = a * a;
+  vfloat r = ((((( -0.0117212f * s + 0.05265332f) * s - 0.11643287f) * s
+                + 0.19354346f) * s - 0.33262347f) * s + 0.99997726f) * a;
+
+  r = ay > ax ? BATCH_HALF_PI - r : r;
+  r = x < 0 ? BATCH_PI - r : r;
+  r = y < 0 ? -r : r;
+  return r;
+}
+
+/**
+ * Solve one register worth of targets for one arm.
+ * Works in the plane of the bicep: u is the distance of the wrist from the
+ * shoulder along the plane, v its height relative to the shoulder and a the
+ * wrist's distance off the plane.
+ */
+static inline vfloat solve_arm(const DeltaBatchGeometry &g, int i,
+                               vfloat ex, vfloat ey, vfloat ez) {
+  const float r0 = g.shoulder_to_elbow;
+  const float r0sq = r0 * r0;
+  const float l2sq = g.elbow_to_wrist * g.elbow_to_wrist;
+
+  vfloat u = ex * g.cos_arm[i] + ey * g.sin_arm[i] + g.wrist_offset;
+  vfloat v = ez - g.shoulder_z;
+  vfloat a = ey * g.cos_arm[i] - ex * g.sin_arm[i];
+
+  // forearm projected onto the plane of the bicep
+  vfloat r1sq = l2sq - a * a;
+  vfloat d = vsqrt(u * u + v * v);
+  vfloat c = (r0sq - r1sq + d * d) / (d + d);
+  vfloat h = vsqrt(r0sq - c * c);
+
+  // elbow relative to shoulder, scaled by d (which does not change the angle)
+  vfloat ex_ = u * c - v * h;
+  vfloat ey_ = v * c + u * h;
+
+  vfloat angle = vatan2(-ey_, ex_) * BATCH_RAD2DEG;
+
+  // forearm can't reach the plane at all
+  return r1sq < 0 ? vsplat(NAN) : angle;
+}
+
+static inline void solve_chunk(const DeltaBatchGeometry &g,
+                               const float *x, const float *y, const float *z,
+                               float *angle1, float *angle2, float *angle3) {
+  vfloat ex, ey, ez;
+  __builtin_memcpy(&ex, x, sizeof(vfloat));
+  __builtin_memcpy(&ey, y, sizeof(vfloat));
+  __builtin_memcpy(&ez, z, sizeof(vfloat));
+
+  // tool tip -> end effector
+  ex -= g.tool_x;
+  ey -= g.tool_y;
+  ez -= g.tool_z;
+
+  vfloat r1 = solve_arm(g, 0, ex, ey, ez);
+  vfloat r2 = solve_arm(g, 1, ex, ey, ez);
+  vfloat r3 = solve_arm(g, 2, ex, ey, ez);
+
+  __builtin_memcpy(angle1, &r1, sizeof(vfloat));
+  __builtin_memcpy(angle2, &r2, sizeof(vfloat));
+  __builtin_memcpy(angle3, &r3, sizeof(vfloat));
+}
+
+int delta_ik_batch(const DeltaBatchGeometry &geometry,
+                   const float *x, const float *y, const float *z,
+                   float *angle1, float *angle2, float *angle3,
+                   int n) {
+  int i;
+  for (i = 0; i + BATCH_WIDTH <= n; i += BATCH_WIDTH) {
+    solve_chunk(geometry, x + i, y + i, z + i, angle1 + i, angle2 + i, angle3 + i);
+  }
+
+  // pad the remainder out to a full register
+  int rest = n - i;
+  if (rest > 0) {
+    float tx[BATCH_WIDTH] = {0}, ty[BATCH_WIDTH] = {0}, tz[BATCH_WIDTH] = {0};
+    float t1[BATCH_WIDTH], t2[BATCH_WIDTH], t3[BATCH_WIDTH];
+    for (int j = 0; j < rest; ++j) {
+      tx[j] = x[i + j];
+      ty[j] = y[i + j];
+      tz[j] = z[i + j];
+    }
+    solve_chunk(geometry, tx, ty, tz, t1, t2, t3);
+    for (int j = 0; j < rest; ++j) {
+      angle1[i + j] = t1[j];
+      angle2[i + j] = t2[j];
+      angle3[i + j] = t3[j];
+    }
+  }
+
+  int valid = 0;
+  for (i = 0; i < n; ++i) {
+    if (!isnan(angle1[i]) && !isnan(angle2[i]) && !isnan(angle3[i])) ++valid;
+  }
+  return valid;
+}
+
+int delta_ik_batch_width() {
+  return BATCH_WIDTH;
+}
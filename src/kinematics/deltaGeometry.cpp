@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+// Geometry descriptors, see deltaGeometry.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaGeometry.h"
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+constexpr float UprootArmSpec::center_to_shoulder;
+constexpr float UprootArmSpec::shoulder_to_elbow;
+constexpr float UprootArmSpec::elbow_to_wrist;
+constexpr float UprootArmSpec::effector_to_wrist;
+constexpr float UprootArmSpec::center_to_floor;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+DeltaRuntimeGeometry::DeltaRuntimeGeometry() {
+  memset(&geometry_, 0, sizeof(geometry_));
+  memset(cos_, 0, sizeof(cos_));
+  memset(sin_, 0, sizeof(sin_));
+  for(int i=0;i<NUM_AXIES;++i) {
+    arms_[i].shoulder.MakeZero();
+    arms_[i].plane_ortho.MakeZero();
+    arms_[i].plane_normal.MakeZero();
+    arms_[i].elbow_relative.MakeZero();
+    arms_[i].wrist_relative.MakeZero();
+  }
+}
+
+/**
+ * setup the geometry of the robot for faster inverse kinematics later
+ */
+DeltaRuntimeGeometry::DeltaRuntimeGeometry(const DeltaGeometry &geometry)
+  : geometry_(geometry) {
+  int i;
+  float frac=TWOPI/(float)NUM_AXIES;
+
+  for(i=0;i<NUM_AXIES;++i) {
+    DeltaArmGeometry &a=arms_[i];
+    float c=cos((float)i*frac);
+    float s=sin((float)i*frac);
+    cos_[i]=c;
+    sin_[i]=s;
+
+    // shoulder
+    a.shoulder=Vector3(c*geometry_.center_to_shoulder,
+                       s*geometry_.center_to_shoulder,
+                       geometry_.center_to_floor);
+    a.plane_ortho=a.shoulder;
+    a.plane_ortho.z=0;
+    a.plane_ortho.Normalize();
+
+    a.plane_normal=Vector3(-a.plane_ortho.y, a.plane_ortho.x,0);
+    a.plane_normal.Normalize();
+
+    // elbow
+    a.elbow_relative=Vector3(c*(geometry_.center_to_shoulder+geometry_.shoulder_to_elbow),
+                             s*(geometry_.center_to_shoulder+geometry_.shoulder_to_elbow),
+                             geometry_.center_to_floor);
+    a.wrist_relative=Vector3(c*geometry_.effector_to_wrist,
+                             s*geometry_.effector_to_wrist,
+                             0);
+  }
+}
@@ -0,0 +1,298 @@
+//------------------------------------------------------------------------------
+// Reentrant delta arm kinematics, see deltaKinematics.h
+//
+// The IK stages are the ones from Delta Robot v8 (deltaRobot.cpp) with the
+// global robot replaced by per-instance geometry.  solve() itself is the
+// plane-reduced version in deltaSolver.h.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaKinematics.h"
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+static const int reverse = 1;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+DeltaKinematics::DeltaKinematics() {
+  memset(&batch_, 0, sizeof(batch_));
+}
+
+/**
+ * setup the geometry of the robot for faster inverse kinematics later
+ */
+DeltaKinematics::DeltaKinematics(const DeltaGeometry &geometry, const Vector3 &toolOffset)
+  : solver_(DeltaRuntimeGeometry(geometry)) {
+  const DeltaRuntimeGeometry &g=solver_.geometry();
+  int i;
+
+  for(i=0;i<NUM_AXIES;++i) {
+    batch_.cos_arm[i]=g.armCos(i);
+    batch_.sin_arm[i]=g.armSin(i);
+  }
+
+  batch_.shoulder_to_elbow=geometry.shoulder_to_elbow;
+  batch_.elbow_to_wrist=geometry.elbow_to_wrist;
+  batch_.wrist_offset=geometry.effector_to_wrist-geometry.center_to_shoulder;
+  batch_.shoulder_z=geometry.center_to_floor;
+
+  setToolOffset(toolOffset);
+}
+
+void DeltaKinematics::setToolOffset(const Vector3 &toolOffset) {
+  solver_.setToolOffset(toolOffset);
+  batch_.tool_x=toolOffset.x;
+  batch_.tool_y=toolOffset.y;
+  batch_.tool_z=toolOffset.z;
+}
+
+/**
+ * Get wrist position based on end effector position.
+ */
+Vector3 DeltaKinematics::wristPosition(int arm, const Vector3 &ee) const {
+  return ee + solver_.geometry().arm(arm).wrist_relative;
+}
+
+/**
+ * Calculate the position of an elbow based on the location of its wrist.
+ */
+Vector3 DeltaKinematics::elbowPosition(int arm, const Vector3 &wrist, Vector3 *wopOut) const {
+  const DeltaArmGeometry &g=solver_.geometry().arm(arm);
+  float a,c,r1,r0,d,h;
+  Vector3 r,mid,wop,w,n;
+
+  // get wrist position on plane of bicep
+  w = wrist - g.shoulder;
+
+  a = w | g.plane_normal;  // ee' distance
+  wop = w - g.plane_normal * a;
+  if(wopOut) *wopOut = wop + g.shoulder;
+
+  // use intersection of circles to find two possible elbow points.
+  // the two circles are the bicep (shoulder-elbow) and the forearm (elbow-wop)
+  // the distance between circle centers is wop.Length()
+  //a = (r0r0 - r1r1 + d*d ) / (2 d)
+  r1=sqrt(geometry().elbow_to_wrist*geometry().elbow_to_wrist-a*a);  // circle 1 centers on wop
+  r0=geometry().shoulder_to_elbow;  // circle 0 centers on shoulder
+  d=wop.Length();
+  c = ( r0 * r0 - r1 * r1 + d*d ) / ( 2*d );
+  // find the midpoint
+  n=wop;
+  n/=d;
+  mid = g.shoulder+(n*c);
+  // with c and r0 we can find h, the distance from midpoint to the intersections.
+  h=sqrt(r0*r0-c*c);
+  // the distance h on a line orthogonal to n and plane_normal gives us the two intersections.
+  r = g.plane_normal ^ n;
+
+  return mid - r * h;
+}
+
+/**
+ * Shoulder angle (degrees) that puts the elbow at the given position.
+ */
+float DeltaKinematics::shoulderAngle(int arm, const Vector3 &elbow) const {
+  const DeltaArmGeometry &g=solver_.geometry().arm(arm);
+  Vector3 temp;
+  float x,y,new_angle;
+
+  // use atan2 to find theta
+  temp = elbow - g.shoulder;
+
+  y = temp.z;
+  temp.z = 0;
+  x = temp.Length();
+
+  if( ( g.elbow_relative | temp ) < 0 ) x=-x;
+
+  new_angle=atan2(-y,x) * RAD2DEG;
+
+  // 2013-05-17 http://www.marginallyclever.com/forum/viewtopic.php?f=12&t=4707&p=5103#p5091
+  return ( (reverse==1) ? new_angle : -new_angle );
+}
+
+/**
+ * Elbow position for a shoulder angle.  Inverse of shoulderAngle().
+ */
+Vector3 DeltaKinematics::elbowAt(int arm, float angle) const {
+  const DeltaArmGeometry &g=solver_.geometry().arm(arm);
+  float rad = ( (reverse==1) ? angle : -angle ) * DEG2RAD;
+
+  return g.shoulder
+       + g.plane_ortho * ( cos(rad) * geometry().shoulder_to_elbow )
+       - Vector3(0,0,1) * ( sin(rad) * geometry().shoulder_to_elbow );
+}
+
+/**
+ * Direction the elbow moves as the shoulder angle increases, per degree.
+ */
+Vector3 DeltaKinematics::elbowTangent(int arm, float angle) const {
+  const DeltaArmGeometry &g=solver_.geometry().arm(arm);
+  float sign = (reverse==1) ? 1.0f : -1.0f;
+  float rad = sign * angle * DEG2RAD;
+  float scale = sign * DEG2RAD * geometry().shoulder_to_elbow;
+
+  return g.plane_ortho * ( -sin(rad) * scale )
+       - Vector3(0,0,1) * ( cos(rad) * scale );
+}
+
+bool DeltaKinematics::solve(const Vector3 &target, float angles[NUM_AXIES]) const {
+  return solver_.solve(target, angles);
+}
+
+/**
+ * Each wrist lies on a sphere of radius ELBOW_TO_WRIST around its elbow.
+ * Shift the spheres by the wrist offsets so they all have to contain the end
+ * effector, then intersect them (trilateration) and keep the lower point.
+ */
+bool DeltaKinematics::forward(const float angles[NUM_AXIES], Vector3 &target) const {
+  Vector3 p[NUM_AXIES];
+  int i;
+
+  for(i=0;i<NUM_AXIES;++i) {
+    p[i] = elbowAt(i, angles[i]) - arm(i).wrist_relative;
+  }
+
+  Vector3 p21 = p[1] - p[0];
+  Vector3 p31 = p[2] - p[0];
+
+  float d = p21.Length();
+  if(d <= 0) return false;
+  Vector3 ex = p21 / d;
+
+  float ii = ex | p31;
+  Vector3 ey = p31 - ex * ii;
+  float j = ey.Length();
+  if(j <= 0) return false;
+  ey /= j;
+  Vector3 ez = ex ^ ey;
+
+  // all three spheres have the same radius
+  float r = geometry().elbow_to_wrist;
+  float x = d * 0.5f;
+  float y = ( ii*ii + j*j ) / ( 2*j ) - ( ii / j ) * x;
+  float zsq = r*r - x*x - y*y;
+  if(zsq < 0) return false;
+  float z = sqrt(zsq);
+
+  Vector3 base = p[0] + ex * x + ey * y;
+  Vector3 a = base + ez * z;
+  Vector3 b = base - ez * z;
+  Vector3 ee = ( a.z < b.z ) ? a : b;
+
+  target = ee + toolOffset();
+  return true;
+}
+
+/**
+ * Each arm keeps |W - E| constant, W the wrist and E the elbow, so
+ *   (W - E) . (v - dE/dangle * rate) = 0
+ * and the rate of each arm only depends on its own forearm direction.
+ */
+bool DeltaKinematics::inverseJacobian(const Vector3 &target, const float angles[NUM_AXIES],
+                                      float jinv[NUM_AXIES][3]) const {
+  Vector3 ee = target - toolOffset();
+  int i;
+
+  for(i=0;i<NUM_AXIES;++i) {
+    Vector3 forearm = wristPosition(i, ee) - elbowAt(i, angles[i]);
+    float denom = forearm | elbowTangent(i, angles[i]);
+
+    // forearm in line with the bicep's motion, the arm has no authority here
+    if(fabs(denom) < 1e-6f * forearm.LengthSquared()) return false;
+
+    jinv[i][0] = forearm.x / denom;
+    jinv[i][1] = forearm.y / denom;
+    jinv[i][2] = forearm.z / denom;
+  }
+  return true;
+}
+
+bool DeltaKinematics::jacobian(const float angles[NUM_AXIES], float j[3][NUM_AXIES]) const {
+  Vector3 target;
+  float m[NUM_AXIES][3];
+
+  if(!forward(angles, target)) return false;
+  if(!inverseJacobian(target, angles, m)) return false;
+
+  // invert the 3x3 by cofactors
+  float c00 = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+  float c01 = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+  float c02 = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+  float det = m[0][0]*c00 + m[0][1]*c01 + m[0][2]*c02;
+  if(fabs(det) < 1e-12f) return false;
+  float inv = 1.0f / det;
+
+  j[0][0] = c00 * inv;
+  j[1][0] = c01 * inv;
+  j[2][0] = c02 * inv;
+  j[0][1] = (m[0][2]*m[2][1] - m[0][1]*m[2][2]) * inv;
+  j[1][1] = (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * inv;
+  j[2][1] = (m[0][1]*m[2][0] - m[0][0]*m[2][1]) * inv;
+  j[0][2] = (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * inv;
+  j[1][2] = (m[0][2]*m[1][0] - m[0][0]*m[1][2]) * inv;
+  j[2][2] = (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * inv;
+  return true;
+}
+
+bool DeltaKinematics::jointVelocity(const Vector3 &target, const float angles[NUM_AXIES],
+                                    const Vector3 &velocity, float rates[NUM_AXIES]) const {
+  float jinv[NUM_AXIES][3];
+  int i;
+
+  if(!inverseJacobian(target, angles, jinv)) return false;
+
+  for(i=0;i<NUM_AXIES;++i) {
+    rates[i] = jinv[i][0]*velocity.x + jinv[i][1]*velocity.y + jinv[i][2]*velocity.z;
+  }
+  return true;
+}
+
+bool DeltaKinematics::stepIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                                      float angles[NUM_AXIES], float tolerance) const {
+  int i;
+  Vector3 step = target - state.anchor;
+
+  if(!state.valid || step.LengthSquared() > tolerance*tolerance) {
+    state.exact_solves++;
+    state.valid = false;
+    return false;
+  }
+  for(i=0;i<NUM_AXIES;++i) {
+    angles[i] = state.angles[i]
+              + state.jinv[i][0]*step.x + state.jinv[i][1]*step.y + state.jinv[i][2]*step.z;
+  }
+  state.incremental_solves++;
+  return true;
+}
+
+void DeltaKinematics::anchorIncremental(const Vector3 &target, const float angles[NUM_AXIES],
+                                        DeltaIncrementalState &state) const {
+  // near a singularity every call falls through to a full solve
+  if(inverseJacobian(target, angles, state.jinv)) {
+    state.anchor = target;
+    for(int i=0;i<NUM_AXIES;++i) state.angles[i] = angles[i];
+    state.valid = true;
+  }
+}
+
+bool DeltaKinematics::solveIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                                       float angles[NUM_AXIES], float tolerance) const {
+  if(stepIncremental(target, state, angles, tolerance)) return true;
+  if(!solve(target, angles)) return false;
+  anchorIncremental(target, angles, state);
+  return true;
+}
+
+int DeltaKinematics::solveBatch(const float *x, const float *y, const float *z,
+                                float *angle1, float *angle2, float *angle3, int n) const {
+  return delta_ik_batch(batch_, x, y, z, angle1, angle2, angle3, n);
+}
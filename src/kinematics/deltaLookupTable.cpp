@@ -0,0 +1,343 @@
+//------------------------------------------------------------------------------
+// Precomputed inverse kinematics, see deltaLookupTable.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaLookupTable.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+static const char LUT_MAGIC[8] = {'U','R','I','K','L','U','T','\0'};
+static const uint32_t LUT_VERSION = 2;
+
+// Don't let a typo in the config eat all the memory
+static const long LUT_MAX_NODES = 16 * 1024 * 1024;
+
+//------------------------------------------------------------------------------
+// STRUCTS
+//------------------------------------------------------------------------------
+
+// On-disk layout: header, node angles, cell flags
+struct LutHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t key;
+  float min[3];
+  float step;
+  int32_t dims[3];
+  uint32_t reserved;
+};
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+static long node_count(const int dims[3]) {
+  return (long)dims[0] * dims[1] * dims[2];
+}
+
+static long cell_count(const int dims[3]) {
+  return (long)(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1);
+}
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+DeltaLookupTable::DeltaLookupTable()
+  : key_(0), step_(0), angles_(0), exact_(0), map_(0), map_size_(0) {
+  memset(min_, 0, sizeof(min_));
+  memset(dims_, 0, sizeof(dims_));
+}
+
+DeltaLookupTable::~DeltaLookupTable() {
+  unmap();
+}
+
+void DeltaLookupTable::unmap() {
+  if (map_) munmap(map_, map_size_);
+  map_ = 0;
+  map_size_ = 0;
+  angles_ = 0;
+  exact_ = 0;
+}
+
+uint64_t DeltaLookupTable::key(const DeltaKinematics &kinematics,
+                               const Vector3 &min, const Vector3 &max,
+                               float resolution, float maxErrorDeg) {
+  const DeltaGeometry &g = kinematics.geometry();
+  float values[] = {
+    g.center_to_shoulder, g.shoulder_to_elbow, g.elbow_to_wrist,
+    g.effector_to_wrist, g.center_to_floor,
+    kinematics.toolOffset().x, kinematics.toolOffset().y, kinematics.toolOffset().z,
+    min.x, min.y, min.z, max.x, max.y, max.z,
+    resolution, maxErrorDeg,
+  };
+
+  uint64_t h = 14695981039346656037ULL;
+  h = fnv1a(h, &LUT_VERSION, sizeof(LUT_VERSION));
+  return fnv1a(h, values, sizeof(values));
+}
+
+bool DeltaLookupTable::build(const DeltaKinematics &kinematics,
+                             const Vector3 &min, const Vector3 &max,
+                             float resolution, float maxErrorDeg, int threads) {
+  if (resolution <= 0 || max.x <= min.x || max.y <= min.y || max.z <= min.z) return false;
+
+  unmap();
+  kinematics_ = kinematics;
+  key_ = key(kinematics, min, max, resolution, maxErrorDeg);
+  step_ = resolution;
+  min_[0] = min.x;
+  min_[1] = min.y;
+  min_[2] = min.z;
+  dims_[0] = (int)ceil((max.x - min.x) / resolution) + 1;
+  dims_[1] = (int)ceil((max.y - min.y) / resolution) + 1;
+  dims_[2] = (int)ceil((max.z - min.z) / resolution) + 1;
+
+  if (node_count(dims_) > LUT_MAX_NODES) return false;
+
+  own_angles_.assign(node_count(dims_) * NUM_AXIES, 0.0f);
+  own_exact_.assign(cell_count(dims_), 0);
+  angles_ = &own_angles_[0];
+  exact_ = &own_exact_[0];
+
+  if (threads <= 0) threads = std::thread::hardware_concurrency();
+  if (threads <= 0) threads = 1;
+
+  // Every thread takes every n'th z plane, first nodes then (after all nodes
+  // are done) cells.
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([this, t, threads] {
+      for (int iz = t; iz < dims_[2]; iz += threads) {
+        for (int iy = 0; iy < dims_[1]; ++iy) {
+          for (int ix = 0; ix < dims_[0]; ++ix) {
+            long node = ((long)iz * dims_[1] + iy) * dims_[0] + ix;
+            Vector3 p(min_[0] + ix * step_, min_[1] + iy * step_, min_[2] + iz * step_);
+            float *out = &own_angles_[node * NUM_AXIES];
+            if (!kinematics_.solve(p, out)) {
+              for (int a = 0; a < NUM_AXIES; ++a) out[a] = NAN;
+            }
+          }
+        }
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+  workers.clear();
+
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([this, t, threads, maxErrorDeg] {
+      for (int iz = t; iz < dims_[2] - 1; iz += threads) {
+        for (int iy = 0; iy < dims_[1] - 1; ++iy) {
+          for (int ix = 0; ix < dims_[0] - 1; ++ix) {
+            long cell = ((long)iz * (dims_[1] - 1) + iy) * (dims_[0] - 1) + ix;
+
+            // interpolation is exact at the corners and worst between them:
+            // checked at the middle of the cell, of each face and of each edge
+            bool flag = false;
+            for (int k = 0; !flag && k < 27; ++k) {
+              float f[3] = {(k % 3) * 0.5f, (k / 3 % 3) * 0.5f, (k / 9) * 0.5f};
+              if (f[0] != 0.5f && f[1] != 0.5f && f[2] != 0.5f) continue;
+
+              Vector3 p(min_[0] + (ix + f[0]) * step_,
+                        min_[1] + (iy + f[1]) * step_,
+                        min_[2] + (iz + f[2]) * step_);
+              float exact[NUM_AXIES], approx[NUM_AXIES];
+              flag = !kinematics_.solve(p, exact) || !interpolate((int)cell, f[0], f[1], f[2], approx);
+              for (int a = 0; !flag && a < NUM_AXIES; ++a) {
+                if (fabs(exact[a] - approx[a]) > maxErrorDeg) flag = true;
+              }
+            }
+            own_exact_[cell] = flag ? 1 : 0;
+          }
+        }
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+
+  return true;
+}
+
+bool DeltaLookupTable::save(const std::string &path) const {
+  if (!valid()) return false;
+
+  LutHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, LUT_MAGIC, sizeof(LUT_MAGIC));
+  header.version = LUT_VERSION;
+  header.header_size = sizeof(LutHeader);
+  header.key = key_;
+  memcpy(header.min, min_, sizeof(min_));
+  header.step = step_;
+  for (int i = 0; i < 3; ++i) header.dims[i] = dims_[i];
+
+  // write next to the target and rename so a half written table is never mapped
+  std::string tmp = path + ".tmp";
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+
+  bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+            fwrite(angles_, sizeof(float), node_count(dims_) * NUM_AXIES, f) == (size_t)(node_count(dims_) * NUM_AXIES) &&
+            fwrite(exact_, 1, cell_count(dims_), f) == (size_t)cell_count(dims_);
+  ok = (fclose(f) == 0) && ok;
+
+  if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool DeltaLookupTable::map(const std::string &path, const DeltaKinematics &kinematics, uint64_t key) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(LutHeader)) {
+    close(fd);
+    return false;
+  }
+
+  void *m = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) return false;
+
+  const LutHeader *header = (const LutHeader *)m;
+  bool ok = memcmp(header->magic, LUT_MAGIC, sizeof(LUT_MAGIC)) == 0 &&
+            header->version == LUT_VERSION &&
+            header->header_size == sizeof(LutHeader) &&
+            header->key == key &&
+            header->dims[0] > 1 && header->dims[1] > 1 && header->dims[2] > 1 &&
+            node_count(header->dims) <= LUT_MAX_NODES;
+  if (ok) {
+    size_t expected = sizeof(LutHeader)
+                    + node_count(header->dims) * NUM_AXIES * sizeof(float)
+                    + cell_count(header->dims);
+    ok = (size_t)st.st_size == expected;
+  }
+  if (!ok) {
+    munmap(m, st.st_size);
+    return false;
+  }
+
+  unmap();
+  own_angles_.clear();
+  own_exact_.clear();
+
+  map_ = m;
+  map_size_ = st.st_size;
+  kinematics_ = kinematics;
+  key_ = key;
+  memcpy(min_, header->min, sizeof(min_));
+  step_ = header->step;
+  for (int i = 0; i < 3; ++i) dims_[i] = header->dims[i];
+  angles_ = (const float *)((const char *)m + sizeof(LutHeader));
+  exact_ = (const uint8_t *)(angles_ + node_count(dims_) * NUM_AXIES);
+  return true;
+}
+
+bool DeltaLookupTable::loadOrBuild(const DeltaKinematics &kinematics,
+                                   const Vector3 &min, const Vector3 &max,
+                                   float resolution, float maxErrorDeg,
+                                   const std::string &path) {
+  if (map(path, kinematics, key(kinematics, min, max, resolution, maxErrorDeg))) return true;
+
+  if (!build(kinematics, min, max, resolution, maxErrorDeg)) return false;
+
+  // A table we can't cache is still a table
+  save(path);
+  return true;
+}
+
+bool DeltaLookupTable::interpolate(int cell, float fx, float fy, float fz, float angles[NUM_AXIES]) const {
+  int nx = dims_[0] - 1;
+  int ny = dims_[1] - 1;
+  int ix = cell % nx;
+  int iy = (cell / nx) % ny;
+  int iz = cell / (nx * ny);
+
+  long sx = NUM_AXIES;
+  long sy = (long)dims_[0] * NUM_AXIES;
+  long sz = (long)dims_[0] * dims_[1] * NUM_AXIES;
+  const float *p = angles_ + iz * sz + iy * sy + ix * sx;
+
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    float c00 = p[a]           + (p[a + sx]           - p[a])           * fx;
+    float c10 = p[a + sy]      + (p[a + sy + sx]      - p[a + sy])      * fx;
+    float c01 = p[a + sz]      + (p[a + sz + sx]      - p[a + sz])      * fx;
+    float c11 = p[a + sz + sy] + (p[a + sz + sy + sx] - p[a + sz + sy]) * fx;
+    float c0 = c00 + (c10 - c00) * fy;
+    float c1 = c01 + (c11 - c01) * fy;
+    angles[a] = c0 + (c1 - c0) * fz;
+    if (isnan(angles[a])) return false;
+  }
+  return true;
+}
+
+bool DeltaLookupTable::lookup(const Vector3 &target, float angles[NUM_AXIES]) const {
+  if (!valid()) return false;
+
+  float gx = (target.x - min_[0]) / step_;
+  float gy = (target.y - min_[1]) / step_;
+  float gz = (target.z - min_[2]) / step_;
+  int ix = (int)floor(gx);
+  int iy = (int)floor(gy);
+  int iz = (int)floor(gz);
+
+  // the far faces belong to the last cell
+  if (ix == dims_[0] - 1 && gx == (float)ix) --ix;
+  if (iy == dims_[1] - 1 && gy == (float)iy) --iy;
+  if (iz == dims_[2] - 1 && gz == (float)iz) --iz;
+
+  if (ix < 0 || iy < 0 || iz < 0 ||
+      ix >= dims_[0] - 1 || iy >= dims_[1] - 1 || iz >= dims_[2] - 1) return false;
+
+  int cell = (iz * (dims_[1] - 1) + iy) * (dims_[0] - 1) + ix;
+  if (exact_[cell]) return false;
+
+  return interpolate(cell, gx - ix, gy - iy, gz - iz, angles);
+}
+
+bool DeltaLookupTable::solve(const Vector3 &target, float angles[NUM_AXIES]) const {
+  if (lookup(target, angles)) return true;
+  return kinematics_.solve(target, angles);
+}
+
+bool DeltaLookupTable::solveIncremental(const Vector3 &target, DeltaIncrementalState &state,
+                                        float angles[NUM_AXIES], float tolerance) const {
+  if (kinematics_.stepIncremental(target, state, angles, tolerance)) return true;
+  if (!solve(target, angles)) return false;
+  kinematics_.anchorIncremental(target, angles, state);
+  return true;
+}
+
+int DeltaLookupTable::cells() const {
+  return valid() ? (int)cell_count(dims_) : 0;
+}
+
+int DeltaLookupTable::exactCells() const {
+  int n = 0;
+  for (int i = 0; i < cells(); ++i) n += exact_[i];
+  return n;
+}
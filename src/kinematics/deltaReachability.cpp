@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+// Reachability map, see deltaReachability.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaReachability.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+const float DeltaReachability::UNREACHABLE = -90.0f;
+
+// Don't let a typo in the config eat all the memory
+static const long REACH_MAX_NODES = 16 * 1024 * 1024;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+DeltaReachability::DeltaReachability() : inv_step_(0) {
+  memset(min_, 0, sizeof(min_));
+  memset(dims_, 0, sizeof(dims_));
+}
+
+bool DeltaReachability::build(const DeltaKinematics &kinematics,
+                              const Vector3 &min, const Vector3 &max, float resolution,
+                              float minAngle, float maxAngle, int threads) {
+  if (resolution <= 0 || max.x <= min.x || max.y <= min.y || max.z <= min.z) return false;
+
+  min_[0] = min.x;
+  min_[1] = min.y;
+  min_[2] = min.z;
+  inv_step_ = 1.0f / resolution;
+  dims_[0] = (int)ceil((max.x - min.x) / resolution) + 1;
+  dims_[1] = (int)ceil((max.y - min.y) / resolution) + 1;
+  dims_[2] = (int)ceil((max.z - min.z) / resolution) + 1;
+
+  long nodes = (long)dims_[0] * dims_[1] * dims_[2];
+  if (nodes > REACH_MAX_NODES) {
+    margins_.clear();
+    return false;
+  }
+  margins_.assign(nodes, UNREACHABLE);
+
+  if (threads <= 0) threads = std::thread::hardware_concurrency();
+  if (threads <= 0) threads = 1;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([&, t] {
+      for (int iz = t; iz < dims_[2]; iz += threads) {
+        for (int iy = 0; iy < dims_[1]; ++iy) {
+          for (int ix = 0; ix < dims_[0]; ++ix) {
+            Vector3 p(min.x + ix * resolution, min.y + iy * resolution, min.z + iz * resolution);
+            float angles[NUM_AXIES];
+            if (!kinematics.solve(p, angles)) continue;
+
+            float m = maxAngle - minAngle;
+            for (int a = 0; a < NUM_AXIES; ++a) {
+              m = std::min(m, std::min(angles[a] - minAngle, maxAngle - angles[a]));
+            }
+            margins_[((long)iz * dims_[1] + iy) * dims_[0] + ix] = std::max(m, UNREACHABLE);
+          }
+        }
+      }
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+
+  return true;
+}
+
+float DeltaReachability::margin(const Vector3 &target) const {
+  if (!valid()) return UNREACHABLE;
+
+  float gx = (target.x - min_[0]) * inv_step_;
+  float gy = (target.y - min_[1]) * inv_step_;
+  float gz = (target.z - min_[2]) * inv_step_;
+
+  // outside the box (NaN fails these too)
+  if (!(gx >= 0 && gy >= 0 && gz >= 0 &&
+        gx <= dims_[0] - 1 && gy <= dims_[1] - 1 && gz <= dims_[2] - 1)) return UNREACHABLE;
+
+  int ix = std::min((int)gx, dims_[0] - 2);
+  int iy = std::min((int)gy, dims_[1] - 2);
+  int iz = std::min((int)gz, dims_[2] - 2);
+  float fx = gx - ix;
+  float fy = gy - iy;
+  float fz = gz - iz;
+
+  long sy = dims_[0];
+  long sz = (long)dims_[0] * dims_[1];
+  const float *p = &margins_[iz * sz + iy * sy + ix];
+
+  float c00 = p[0]       + (p[1]          - p[0])       * fx;
+  float c10 = p[sy]      + (p[sy + 1]      - p[sy])      * fx;
+  float c01 = p[sz]      + (p[sz + 1]      - p[sz])      * fx;
+  float c11 = p[sz + sy] + (p[sz + sy + 1] - p[sz + sy]) * fx;
+  float c0 = c00 + (c10 - c00) * fy;
+  float c1 = c01 + (c11 - c01) * fy;
+  return c0 + (c1 - c0) * fz;
+}
+
+int DeltaReachability::query(const float *x, const float *y, const float *z,
+                             float *margins, int n, float minMargin) const {
+  int count = 0;
+  for (int i = 0; i < n; ++i) {
+    margins[i] = margin(Vector3(x[i], y[i], z[i]));
+    if (margins[i] >= minMargin) ++count;
+  }
+  return count;
+}
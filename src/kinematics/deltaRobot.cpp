@@ -18,19 +18,12 @@
 //------------------------------------------------------------------------------
 DeltaRobot robot;
 
-//------------------------------------------------------------------------------
-// CONSTANTS
-//------------------------------------------------------------------------------
-
-// physical measurements of the machine
-// UPDATED for UpRoot Robotics
-#define CENTER_TO_SHOULDER       (7.5f)  // cm
-#define SHOULDER_TO_ELBOW        (30.0f)  // cm
-#define ELBOW_TO_WRIST           (45.0f)  // cm
-#define EFFECTOR_TO_WRIST        (5.0f)  // cm
-#define CENTER_TO_FLOOR          (55.0)  // cm
+// Geometry for the global robot.  The functions below are a shim over it.
+static DeltaKinematics kinematics;
 
-const int reverse = 1;
+// physical measurements of the machine, the arm as built (UprootArmSpec)
+// unless robot_set_geometry() says otherwise
+static DeltaGeometry measurements = DeltaStaticGeometry<UprootArmSpec>::measurements();
 
 //------------------------------------------------------------------------------
 // METHODS
@@ -69,47 +62,73 @@ void robot_position(float npx,float npy,float npz) {
   update_ik();
 }
 
+/**
+ * Physical measurements of the machine
+ */
+DeltaGeometry robot_geometry() {
+  return measurements;
+}
+
+/**
+ * Use other measurements (e.g. read from the config) for the machine.
+ * Takes effect at the next deltarobot_setup().
+ */
+void robot_set_geometry(const DeltaGeometry &g) {
+  measurements=g;
+}
+
+/**
+ * Kinematics of the global robot with its current tool.  Copy this to solve
+ * on other threads.
+ */
+const DeltaKinematics &robot_kinematics() {
+  return kinematics;
+}
+
+/**
+ * Fill in the geometry used by the batched solver.  Uses the current tool.
+ */
+void robot_batch_geometry(DeltaBatchGeometry* geometry) {
+  *geometry = kinematics.batchGeometry();
+}
+
+/**
+ * Find the angles for many positions at once without touching the robot state.
+ * @input npx,npy,npz arrays of n positions
+ * @output angle1Deg..angle3Deg arrays of n angles, NaN where unreachable
+ * @return number of reachable positions
+ */
+int robot_position_batch(const float* npx, const float* npy, const float* npz,
+                         float* angle1Deg, float* angle2Deg, float* angle3Deg, int n) {
+  return kinematics.solveBatch(npx, npy, npz, angle1Deg, angle2Deg, angle3Deg, n);
+}
+
 /**
  * setup the geometry of the robot for faster inverse kinematics later
  */
 void deltarobot_setup() {
-  Vector3 temp,n;
   int i;
 
-  float frac=TWOPI/(float)NUM_AXIES;
-  
+  kinematics = DeltaKinematics(robot_geometry(), robot.tool_offset[0]);
+
   for(i=0;i<NUM_AXIES;++i) {
     Arm &a=robot.arms[i];
-    // shoulder
-    a.shoulder=Vector3(cos((float)i*frac)*CENTER_TO_SHOULDER,  
-                       sin((float)i*frac)*CENTER_TO_SHOULDER,
-                       CENTER_TO_FLOOR);
-    a.plane_ortho=a.shoulder;
-    a.plane_ortho.z=0;
-    a.plane_ortho.Normalize();
-    
-    a.plane_normal=Vector3(-a.plane_ortho.y, a.plane_ortho.x,0);
-    a.plane_normal.Normalize();
-    
-    // elbow
-    a.elbow.pos=Vector3(cos((float)i*frac)*(CENTER_TO_SHOULDER+SHOULDER_TO_ELBOW),
-                        sin((float)i*frac)*(CENTER_TO_SHOULDER+SHOULDER_TO_ELBOW),
-                        CENTER_TO_FLOOR);
-    // Find wrist position.
-    a.elbow.relative.x=a.elbow.pos.x;
-    a.elbow.relative.y=a.elbow.pos.y;
-    a.elbow.relative.z=a.elbow.pos.z;
-    a.wrist.relative=Vector3(cos((float)i*frac)*EFFECTOR_TO_WRIST,
-                             sin((float)i*frac)*EFFECTOR_TO_WRIST,
-                             0);
+    const DeltaArmGeometry &g=kinematics.arm(i);
+
+    a.shoulder=g.shoulder;
+    a.plane_ortho=g.plane_ortho;
+    a.plane_normal=g.plane_normal;
+    a.elbow.pos=g.elbow_relative;
+    a.elbow.relative=g.elbow_relative;
+    a.wrist.relative=g.wrist_relative;
     a.new_step=0;
   }
 
   // Find wrist height
   robot.ee.x=0;
   robot.ee.y=0;
-  float aa = CENTER_TO_SHOULDER + SHOULDER_TO_ELBOW - EFFECTOR_TO_WRIST;
-  float cc = ELBOW_TO_WRIST;
+  float aa = measurements.center_to_shoulder + measurements.shoulder_to_elbow - measurements.effector_to_wrist;
+  float cc = measurements.elbow_to_wrist;
   float bb = sqrt(cc*cc - aa*aa);
   robot.ee.z = robot.arms[0].shoulder.z - bb;
   
@@ -146,7 +165,7 @@ void update_wrist_positions() {
   for(i=0;i<NUM_AXIES;++i) {
     Arm &arm=robot.arms[i];
 
-    arm.wrist.pos = robot.ee + arm.wrist.relative;
+    arm.wrist.pos = kinematics.wristPosition(i, robot.ee);
   }
 }
 
@@ -155,86 +174,24 @@ void update_wrist_positions() {
  * Calculate the position of each elbow based on the current location of the wrists.
  */
 void update_elbows() {
-  float a,b,c,r1,r0,d,h;
-  Vector3 r,p1,mid,wop,w,n;
   int i;
   for(i=0;i<NUM_AXIES;++i) {
     Arm &arm=robot.arms[i];
 
-    // get wrist position on plane of bicep
-    w = arm.wrist.pos - arm.shoulder;
-    
-    a = w | arm.plane_normal;  // ee' distance
-    wop = w - arm.plane_normal * a;
-    arm.wop.pos = wop + arm.shoulder;
-    
-    // use intersection of circles to find two possible elbow points.
-    // the two circles are the bicep (shoulder-elbow) and the forearm (elbow-arm.wop.pos)
-    // the distance between circle centers is wop.Length()
-    //a = (r0r0 - r1r1 + d*d ) / (2 d) 
-    r1=sqrt(ELBOW_TO_WRIST*ELBOW_TO_WRIST-a*a);  // circle 1 centers on wop
-    r0=SHOULDER_TO_ELBOW;  // circle 0 centers on shoulder
-    d=wop.Length();
-    c = ( r0 * r0 - r1 * r1 + d*d ) / ( 2*d );
-    // find the midpoint
-    n=wop;
-    n/=d;
-    mid = arm.shoulder+(n*c);
-    // with c and r0 we can find h, the distance from midpoint to the intersections.
-    h=sqrt(r0*r0-c*c);
-    // the distance h on a line orthogonal to n and plane_normal gives us the two intersections.
-    r = arm.plane_normal ^ n;
-    p1 = mid - r * h;
-    //p2 = mid + r * h;
-    
-    arm.elbow.pos=p1;
+    arm.elbow.pos = kinematics.elbowPosition(i, arm.wrist.pos, &arm.wop.pos);
   }
 }
 
 
 void update_shoulder_angles() {
-  Vector3 temp;
-  float x,y,new_angle,nx;
   int i;
-  
+
   for(i=0;i<NUM_AXIES;++i) {
     Arm &arm=robot.arms[i];
-    
-    // get the angle of each shoulder
-    // use atan2 to find theta
-    temp = arm.elbow.pos - arm.shoulder;
-
-    y = temp.z;
-    temp.z = 0;
-    x = temp.Length();
-        
-    if( ( arm.elbow.relative | temp ) < 0 ) x=-x;
-
-    new_angle=atan2(-y,x) * RAD2DEG;
-    // cap the angle
-    //if(new_angle>90) new_angle=90;
-    //if(new_angle<-90) new_angle=-90;
-
-    // we don't care about elbow angle, but we could find it here if we needed it.
-
-    //Serial.print(i==0?"\tAng=":",");
-    //Serial.print(new_angle,2); 
-    //if(i==2) Serial.print("\n"); 
 
     // update servo to match the new IK data
-    // 2013-05-17 http://www.marginallyclever.com/forum/viewtopic.php?f=12&t=4707&p=5103#p5091
-    nx = ( (reverse==1) ? new_angle : -new_angle );
-  /*
-    if(nx>MAX_ANGLE) {
-      Serial.println("over max");
-      nx=MAX_ANGLE;
-    }
-    if(nx<MIN_ANGLE) {
-      Serial.println("under min");
-      nx=MIN_ANGLE;
-    }
-  */
-    arm.angle=nx;
+    // (same solver as DeltaKinematics::solve, so both agree to the bit)
+    arm.angle = kinematics.solver().solveArm(i, robot.ee);
   }
 
 #if VERBOSE > 0
@@ -263,6 +220,8 @@ void robot_tool_offset(int axis,float x,float y,float z) {
   robot.tool_offset[axis].x=x;
   robot.tool_offset[axis].y=y;
   robot.tool_offset[axis].z=z;
+
+  if(axis==robot.current_tool) kinematics.setToolOffset(robot.tool_offset[axis]);
 }
 
 
@@ -272,27 +231,17 @@ void robot_tool_offset(int axis,float x,float y,float z) {
 
 
 /**
- * can the tool reach a given point?
- * @param test the point to test
+ * can the tool reach a given point?  Exact; DeltaReachability answers the same
+ * question (with joint limits) from a precomputed map.
+ * @param test the end effector point to test
  * @return 1=out of bounds (fail), 0=in bounds (pass)
  */
 char outOfBounds(float x,float y,float z) {
   // test if the move is impossible
   if(z<0) return 1;
-  
-  int error=0,i;
-  Vector3 w, test(x,y,z);
-  float len;
-  for(i=0;i<NUM_AXIES;++i) {
-    Arm &arm=robot.arms[i];
-    // get wrist position
-    w = test + arm.wrist.relative - arm.shoulder;
 
-    len = w.Length() - ELBOW_TO_WRIST;
-    
-    if(fabs(len) > SHOULDER_TO_ELBOW) return 1;
-  }
-  return 0;
+  float angles[NUM_AXIES];
+  return kinematics.solve(Vector3(x,y,z)+kinematics.toolOffset(), angles) ? 0 : 1;
 }
 
 
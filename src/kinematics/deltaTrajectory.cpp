@@ -0,0 +1,325 @@
+//------------------------------------------------------------------------------
+// Time-parameterized moves, see deltaTrajectory.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "deltaTrajectory.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+// Bisection steps when inverting the profile; plenty for float
+static const int PROFILE_ITERATIONS = 48;
+
+//------------------------------------------------------------------------------
+// PROFILE
+//------------------------------------------------------------------------------
+
+DeltaMotionProfile::DeltaMotionProfile()
+  : distance_(0), jerk_(0), peak_accel_(0), peak_velocity_(0),
+    tj_(0), ta_(0), tv_(0), duration_(0) {}
+
+/**
+ * Shape of the acceleration phase up to velocity v
+ * @output tj each jerk phase, ta whole phase, ap peak acceleration
+ */
+static void accelPhase(float v, float accel, float jerk, float &tj, float &ta, float &ap) {
+  if (jerk <= 0) {
+    // trapezoid
+    tj = 0;
+    ap = accel;
+    ta = v / accel;
+  } else if (v * jerk >= accel * accel) {
+    // reaches the acceleration limit
+    tj = accel / jerk;
+    ap = accel;
+    ta = v / accel + tj;
+  } else {
+    // jerk straight up then down
+    tj = sqrtf(v / jerk);
+    ap = jerk * tj;
+    ta = 2 * tj;
+  }
+}
+
+bool DeltaMotionProfile::plan(float distance, float velocity, float accel, float jerk) {
+  *this = DeltaMotionProfile();
+  if (!(distance >= 0) || !(velocity > 0) || !(accel > 0)) return false;
+
+  distance_ = distance;
+  jerk_ = jerk > 0 ? jerk : 0;
+  if (distance == 0) return true;
+
+  // The acceleration phase is symmetric, so it covers v * ta / 2
+  float tj, ta, ap;
+  accelPhase(velocity, accel, jerk_, tj, ta, ap);
+  if (velocity * ta > distance) {
+    // too short to cruise; find the peak velocity that just fits
+    float lo = 0, hi = velocity;
+    for (int i = 0; i < PROFILE_ITERATIONS; ++i) {
+      velocity = 0.5f * (lo + hi);
+      accelPhase(velocity, accel, jerk_, tj, ta, ap);
+      if (velocity * ta > distance) hi = velocity;
+      else lo = velocity;
+    }
+    velocity = lo;
+    accelPhase(velocity, accel, jerk_, tj, ta, ap);
+  }
+
+  peak_velocity_ = velocity;
+  peak_accel_ = ap;
+  tj_ = tj;
+  ta_ = ta;
+  tv_ = std::max(0.0f, (distance - velocity * ta) / velocity);
+  duration_ = 2 * ta_ + tv_;
+  return true;
+}
+
+void DeltaMotionProfile::accelerate(float t, float &s, float &v, float &a) const {
+  if (t < tj_) {
+    // jerk up
+    s = jerk_ * t * t * t / 6;
+    v = jerk_ * t * t / 2;
+    a = jerk_ * t;
+  } else if (t <= ta_ - tj_) {
+    // constant acceleration
+    float v1 = peak_accel_ * tj_ / 2;
+    float s1 = peak_accel_ * tj_ * tj_ / 6;
+    float dt = t - tj_;
+    s = s1 + v1 * dt + peak_accel_ * dt * dt / 2;
+    v = v1 + peak_accel_ * dt;
+    a = peak_accel_;
+  } else {
+    // jerk down, mirror of jerk up from the end of the phase
+    float u = ta_ - t;
+    s = peak_velocity_ * ta_ / 2 - (peak_velocity_ * u - jerk_ * u * u * u / 6);
+    v = peak_velocity_ - jerk_ * u * u / 2;
+    a = jerk_ * u;
+  }
+}
+
+void DeltaMotionProfile::sample(float t, float &s, float &v, float &a) const {
+  t = std::max(0.0f, std::min(t, duration_));
+  if (duration_ <= 0) {
+    s = distance_;
+    v = a = 0;
+  } else if (t < ta_) {
+    accelerate(t, s, v, a);
+  } else if (t < ta_ + tv_) {
+    s = peak_velocity_ * ta_ / 2 + peak_velocity_ * (t - ta_);
+    v = peak_velocity_;
+    a = 0;
+  } else {
+    accelerate(duration_ - t, s, v, a);
+    s = distance_ - s;
+    a = -a;
+  }
+}
+
+float DeltaMotionProfile::position(float t) const {
+  float s, v, a;
+  sample(t, s, v, a);
+  return s;
+}
+
+float DeltaMotionProfile::timeAt(float s) const {
+  if (s <= 0) return 0;
+  if (s >= distance_) return duration_;
+
+  float lo = 0, hi = duration_;
+  for (int i = 0; i < PROFILE_ITERATIONS; ++i) {
+    float mid = 0.5f * (lo + hi);
+    if (position(mid) < s) lo = mid;
+    else hi = mid;
+  }
+  return 0.5f * (lo + hi);
+}
+
+//------------------------------------------------------------------------------
+// TRAJECTORY
+//------------------------------------------------------------------------------
+
+/**
+ * Append the points from a to b (a excluded), MM_PER_SEGMENT pieces per cm.
+ * a is a copy since it is usually out.back().
+ */
+static void segmentLine(const Vector3 a, const Vector3 &b, std::vector<Vector3> &out) {
+  int pieces = std::max(1, (int)ceil((b - a).Length() * (float)MM_PER_SEGMENT));
+  for (int i = 1; i <= pieces; ++i) {
+    out.push_back(a + (b - a) * ((float)i / (float)pieces));
+  }
+}
+
+/**
+ * Append the parabola from a to b (a excluded) with control point c
+ */
+static void segmentBlend(const Vector3 &a, const Vector3 &c, const Vector3 &b, std::vector<Vector3> &out) {
+  // the control polygon is never shorter than the curve
+  float len = (c - a).Length() + (b - c).Length();
+  int pieces = std::max(1, (int)ceil(len * (float)MM_PER_SEGMENT));
+  for (int i = 1; i <= pieces; ++i) {
+    float f = (float)i / (float)pieces;
+    out.push_back(a * ((1 - f) * (1 - f)) + c * (2 * f * (1 - f)) + b * (f * f));
+  }
+}
+
+void DeltaTrajectory::clear() {
+  waypoints_.clear();
+  profile_ = DeltaMotionProfile();
+}
+
+bool DeltaTrajectory::line(const DeltaKinematics &kinematics, const Vector3 &start, const Vector3 &end,
+                           const DeltaJointLimits &limits) {
+  std::vector<Vector3> points;
+  points.push_back(start);
+  points.push_back(end);
+  return path(kinematics, points, 0, limits);
+}
+
+bool DeltaTrajectory::path(const DeltaKinematics &kinematics, const std::vector<Vector3> &points,
+                           float blendRadius, const DeltaJointLimits &limits) {
+  clear();
+  if (points.empty()) return false;
+
+  // drop repeated points so every leg has a direction
+  std::vector<Vector3> legs(1, points[0]);
+  for (size_t i = 1; i < points.size(); ++i) {
+    if ((points[i] - legs.back()).LengthSquared() > 1e-12f) legs.push_back(points[i]);
+  }
+
+  // cut the path into pieces, blending each corner over at most half of either leg
+  std::vector<Vector3> dense(1, legs[0]);
+  for (size_t i = 1; i < legs.size(); ++i) {
+    if (i + 1 == legs.size() || blendRadius <= 0) {
+      segmentLine(dense.back(), legs[i], dense);
+      continue;
+    }
+    Vector3 in = legs[i - 1] - legs[i];
+    Vector3 out = legs[i + 1] - legs[i];
+    float r = std::min(blendRadius, std::min(in.Length(), out.Length()) / 2);
+    Vector3 b0 = legs[i] + in * (r / in.Length());
+    Vector3 b1 = legs[i] + out * (r / out.Length());
+    segmentLine(dense.back(), b0, dense);
+    segmentBlend(b0, legs[i], b1, dense);
+  }
+
+  // solve every point and find the steepest joint rate per cm of path
+  waypoints_.resize(dense.size());
+  std::vector<float> s(dense.size(), 0.0f);
+  float rate = 0;
+  for (size_t i = 0; i < dense.size(); ++i) {
+    if (!kinematics.solve(dense[i], waypoints_[i].angles)) {
+      clear();
+      return false;
+    }
+    if (i == 0) continue;
+
+    float ds = (dense[i] - dense[i - 1]).Length();
+    s[i] = s[i - 1] + ds;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      rate = std::max(rate, (float)fabs(waypoints_[i].angles[a] - waypoints_[i - 1].angles[a]) / ds);
+    }
+  }
+
+  return time(s, rate, limits);
+}
+
+bool DeltaTrajectory::joint(const float start[NUM_AXIES], const float end[NUM_AXIES],
+                            const DeltaJointLimits &limits) {
+  clear();
+
+  // the joint that moves furthest sets the pace; one waypoint per degree of it
+  float span = 0;
+  for (int a = 0; a < NUM_AXIES; ++a) span = std::max(span, (float)fabs(end[a] - start[a]));
+  int pieces = std::max(1, (int)ceil(span));
+
+  waypoints_.resize(pieces + 1);
+  std::vector<float> s(pieces + 1);
+  for (int i = 0; i <= pieces; ++i) {
+    float f = (float)i / (float)pieces;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      waypoints_[i].angles[a] = start[a] + (end[a] - start[a]) * f;
+    }
+    s[i] = span * f;
+  }
+
+  return time(s, 1, limits);
+}
+
+bool DeltaTrajectory::time(const std::vector<float> &s, float rate, const DeltaJointLimits &limits) {
+  // no joint moves, so any path speed will do
+  if (rate <= 0) rate = 1;
+
+  if (!profile_.plan(s.back(), limits.velocity / rate, limits.accel / rate, limits.jerk / rate)) {
+    clear();
+    return false;
+  }
+  for (size_t i = 0; i < waypoints_.size(); ++i) {
+    waypoints_[i].t = profile_.timeAt(s[i]);
+  }
+  waypoints_.back().t = profile_.duration();
+  return true;
+}
+
+bool DeltaTrajectory::sample(float t, float angles[NUM_AXIES]) const {
+  if (!valid()) return false;
+
+  const DeltaWaypoint *first = &waypoints_.front();
+  const DeltaWaypoint *last = &waypoints_.back();
+  if (t <= first->t || first == last) {
+    std::copy(first->angles, first->angles + NUM_AXIES, angles);
+    return true;
+  }
+  if (t >= last->t) {
+    std::copy(last->angles, last->angles + NUM_AXIES, angles);
+    return true;
+  }
+
+  // first waypoint after t
+  size_t lo = 0, hi = waypoints_.size() - 1;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (waypoints_[mid].t <= t) lo = mid;
+    else hi = mid;
+  }
+
+  const DeltaWaypoint &a = waypoints_[lo];
+  const DeltaWaypoint &b = waypoints_[hi];
+  float f = b.t > a.t ? (t - a.t) / (b.t - a.t) : 1;
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    angles[i] = a.angles[i] + (b.angles[i] - a.angles[i]) * f;
+  }
+  return true;
+}
+
+void DeltaTrajectory::compact(float tolerance) {
+  if (waypoints_.size() < 3) return;
+
+  std::vector<DeltaWaypoint> kept(1, waypoints_[0]);
+  size_t anchor = 0;
+  for (size_t next = 2; next < waypoints_.size(); ++next) {
+    // can everything between the anchor and next be dropped?
+    const DeltaWaypoint &a = waypoints_[anchor];
+    const DeltaWaypoint &b = waypoints_[next];
+    bool fits = true;
+    for (size_t k = anchor + 1; k < next && fits; ++k) {
+      float f = b.t > a.t ? (waypoints_[k].t - a.t) / (b.t - a.t) : 0;
+      for (int i = 0; i < NUM_AXIES; ++i) {
+        float lerp = a.angles[i] + (b.angles[i] - a.angles[i]) * f;
+        if (fabs(lerp - waypoints_[k].angles[i]) > tolerance) fits = false;
+      }
+    }
+    if (!fits) {
+      anchor = next - 1;
+      kept.push_back(waypoints_[anchor]);
+    }
+  }
+  kept.push_back(waypoints_.back());
+  waypoints_.swap(kept);
+}
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+// Weeds split between arms, see weedAssigner.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "weedAssigner.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+WeedAssigner::WeedAssigner(const std::vector<const WeedScheduler *> &arms, float clearance)
+  : arms_(arms), clearance_(clearance), orders_(arms.size()), claimed_(arms.size()) {}
+
+/**
+ * Far enough from the weeds of every other arm
+ */
+bool WeedAssigner::clear(int arm, const Vector3 &position) const {
+  for (size_t a = 0; a < claimed_.size(); ++a) {
+    if ((int)a == arm) continue;
+    for (size_t i = 0; i < claimed_[a].size(); ++i) {
+      float dx = position.x - claimed_[a][i].x;
+      float dy = position.y - claimed_[a][i].y;
+      if (dx * dx + dy * dy < clearance_ * clearance_) return false;
+    }
+  }
+  return true;
+}
+
+const std::vector<int> &WeedAssigner::assign(const std::vector<ArmSlot> &slots, const std::vector<WeedCandidate> &weeds) {
+  int n = (int)arms_.size();
+  assigned_.assign(weeds.size(), -1);
+
+  std::vector<float> free(n);
+  std::vector<float> poses(n * NUM_AXIES);
+  for (int a = 0; a < n; ++a) {
+    orders_[a].clear();
+    claimed_[a].clear();
+    if (slots[a].held >= 0) claimed_[a].push_back(slots[a].held_position);
+    free[a] = slots[a].free;
+    std::copy(slots[a].angles, slots[a].angles + NUM_AXIES, poses.begin() + a * NUM_AXIES);
+  }
+
+  // a weed being worked on stays with its arm
+  std::vector<std::pair<float, int> > byExit;
+  for (size_t i = 0; i < weeds.size(); ++i) {
+    for (int a = 0; a < n; ++a) {
+      if (weeds[i].id == slots[a].held) assigned_[i] = a;
+    }
+    // the weeds all move with the ground, so the ones furthest along leave first
+    if (assigned_[i] < 0) byExit.push_back(std::make_pair(weeds[i].position.y, (int)i));
+  }
+  std::sort(byExit.begin(), byExit.end());
+
+  for (size_t k = 0; k < byExit.size(); ++k) {
+    const WeedCandidate &w = weeds[byExit[k].second];
+    int best = -1;
+    float bestDone = 0;
+    float bestAngles[NUM_AXIES];
+
+    for (int a = 0; a < n; ++a) {
+      if (!clear(a, w.position)) continue;
+
+      WeedCandidate local = w;
+      local.position = w.position - Vector3(slots[a].mount.x, slots[a].mount.y, 0);
+      float angles[NUM_AXIES], done;
+      if (!arms_[a]->visit(local, &poses[a * NUM_AXIES], free[a], angles, done)) continue;
+      if (best >= 0 && done >= bestDone) continue;
+
+      best = a;
+      bestDone = done;
+      std::copy(angles, angles + NUM_AXIES, bestAngles);
+    }
+    if (best < 0) continue;
+
+    assigned_[byExit[k].second] = best;
+    orders_[best].push_back(w.id);
+    claimed_[best].push_back(w.position);
+    free[best] = bestDone;
+    std::copy(bestAngles, bestAngles + NUM_AXIES, poses.begin() + best * NUM_AXIES);
+  }
+  return assigned_;
+}
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+// Tracked weed motion predictor, see weedPredictor.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "weedPredictor.h"
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+// Velocity before anything is known about it: the weeds move at ground
+// speed, which is well under this (cm/s)
+static const float INITIAL_VELOCITY_SD = 50.0f;
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+void WeedPredictor::Axis::init(float position, float positionVar, float velocityVar) {
+  p = position;
+  v = 0;
+  pp = positionVar;
+  pv = 0;
+  vv = velocityVar;
+}
+
+/**
+ * Constant velocity over dt, with white acceleration noise
+ */
+void WeedPredictor::Axis::predict(float dt, float accelVar) {
+  float dt2 = dt * dt;
+  p += v * dt;
+  pp += dt * (pv + pv) + dt2 * vv + 0.25f * dt2 * dt2 * accelVar;
+  pv += dt * vv + 0.5f * dt2 * dt * accelVar;
+  vv += dt2 * accelVar;
+}
+
+void WeedPredictor::Axis::observePosition(float z, float var) {
+  float s = pp + var;
+  float kp = pp / s;
+  float kv = pv / s;
+  float r = z - p;
+
+  p += kp * r;
+  v += kv * r;
+  vv -= kv * pv;
+  pv -= kp * pv;
+  pp -= kp * pp;
+}
+
+void WeedPredictor::Axis::observeVelocity(float z, float var) {
+  float s = vv + var;
+  float kp = pv / s;
+  float kv = vv / s;
+  float r = z - v;
+
+  p += kp * r;
+  v += kv * r;
+  pp -= kp * pv;
+  pv -= kv * pv;
+  vv -= kv * vv;
+}
+
+WeedPredictor::WeedPredictor(const WeedPredictorNoise &noise)
+  : noise_(noise), valid_(false), t_(0), velocity_t_(0), z_(0) {
+  x_.init(0, 0, 0);
+  y_.init(0, 0, 0);
+}
+
+void WeedPredictor::advance(double t) {
+  if (t <= t_) return;
+  float dt = (float)(t - t_);
+  float accelVar = noise_.accel * noise_.accel;
+  x_.predict(dt, accelVar);
+  y_.predict(dt, accelVar);
+  t_ = t;
+}
+
+void WeedPredictor::updatePosition(double t, const Vector3 &position) {
+  float var = noise_.position * noise_.position;
+
+  if (!valid_) {
+    float velocityVar = INITIAL_VELOCITY_SD * INITIAL_VELOCITY_SD;
+    x_.init(position.x, var, velocityVar);
+    y_.init(position.y, var, velocityVar);
+    z_ = position.z;
+    t_ = t;
+    velocity_t_ = -INFINITY;
+    valid_ = true;
+    return;
+  }
+  if (t <= t_) return;
+
+  advance(t);
+  x_.observePosition(position.x, var);
+  y_.observePosition(position.y, var);
+  z_ = position.z;
+}
+
+void WeedPredictor::updateVelocity(double t, float velocityY) {
+  if (!valid_ || t <= velocity_t_) return;
+  velocity_t_ = t;
+
+  // Fused at the filter's own time, not moved on to the reading's: readings
+  // are stamped when they arrive, after the capture time of the positions
+  // still to come, which would then all be dropped.  Ground speed changes
+  // slowly enough for that not to matter.
+  y_.observeVelocity(velocityY, noise_.velocity * noise_.velocity);
+}
+
+Vector3 WeedPredictor::predict(double t) const {
+  float dt = t > t_ ? (float)(t - t_) : 0;
+  return Vector3(x_.p + x_.v * dt, y_.p + y_.v * dt, z_);
+}
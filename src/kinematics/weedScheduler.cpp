@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+// Lookahead weed ordering, see weedScheduler.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "weedScheduler.h"
+#include "deltaFrame.h"
+
+#include <algorithm>
+#include <math.h>
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+WeedScheduler::WeedScheduler(const DeltaKinematics &kinematics, const WeedSchedulerConfig &config)
+  : kinematics_(kinematics), config_(config), best_count_(0), finish_(0), expanded_(0) {}
+
+/**
+ * Rest to rest, every shoulder on the same profile as the longest move
+ */
+float WeedScheduler::travelTime(const float from[NUM_AXIES], const float to[NUM_AXIES]) const {
+  float longest = 0;
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    longest = std::max(longest, (float)fabs(to[i] - from[i]));
+  }
+
+  DeltaMotionProfile profile;
+  if (!profile.plan(longest, config_.limits.velocity, config_.limits.accel, config_.limits.jerk)) return 0;
+  return profile.duration();
+}
+
+/**
+ * The weed keeps moving while the arm travels, so time the move to where it
+ * is at t, then again to where it will be on arrival.  A weed that hasn't
+ * come into the workspace yet is waited for.
+ */
+bool WeedScheduler::visit(const WeedCandidate &w, const float from[NUM_AXIES], float t,
+                          float angles[NUM_AXIES], float &done) const {
+  float enter = t;
+  if (w.position.y > config_.y_max) {
+    if (w.velocity.y >= 0) return false;
+    enter = std::max(t, (w.position.y - config_.y_max) / -w.velocity.y);
+  }
+
+  float arrive = enter;
+  for (int i = 0; i < 2; ++i) {
+    Vector3 p = w.position + w.velocity * arrive;
+    if (p.x < config_.x_min || p.x > config_.x_max || p.y < config_.y_min || p.y > config_.y_max) return false;
+    if (!kinematics_.solve(delta_frame_position(p.x, p.y, p.z, config_.soil_offset), angles)) return false;
+    arrive = std::max(t + travelTime(from, angles), enter);
+  }
+
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    if (angles[i] < config_.min_angle || angles[i] > config_.max_angle) return false;
+  }
+
+  // still inside at the end of the dwell
+  done = arrive + config_.dwell;
+  return w.position.y + w.velocity.y * done >= config_.y_min;
+}
+
+void WeedScheduler::search(int depth, int count, float t, const float from[NUM_AXIES]) {
+  expanded_++;
+
+  if (count > best_count_ || (count == best_count_ && count > 0 && t < finish_)) {
+    best_count_ = count;
+    finish_ = t;
+    order_.clear();
+    for (size_t i = 0; i < path_.size(); ++i) order_.push_back(window_[path_[i]].id);
+  }
+
+  // adding weeds only adds time, so a branch that can at best tie on count
+  // has to already be ahead on time
+  int remaining = std::min(config_.horizon - depth, (int)window_.size() - depth);
+  if (remaining <= 0) return;
+  if (count + remaining < best_count_) return;
+  if (count + remaining == best_count_ && t >= finish_) return;
+
+  for (size_t i = 0; i < window_.size(); ++i) {
+    if (used_[i]) continue;
+
+    float angles[NUM_AXIES], done;
+    if (!visit(window_[i], from, t, angles, done)) continue;
+
+    used_[i] = true;
+    path_.push_back((int)i);
+    search(depth + 1, count + 1, done, angles);
+    path_.pop_back();
+    used_[i] = false;
+  }
+}
+
+const std::vector<int> &WeedScheduler::plan(const float angles[NUM_AXIES], const std::vector<WeedCandidate> &weeds) {
+  // the weeds leaving first, less those no order can get to: never coming
+  // in, or gone before a dwell could be over.  Whether the rest can be
+  // reached depends on where the arm is and when, so the search decides.
+  std::vector<std::pair<float, int> > byExit;
+  for (size_t i = 0; i < weeds.size(); ++i) {
+    const WeedCandidate &w = weeds[i];
+    if (w.position.y > config_.y_max && w.velocity.y >= 0) continue;
+    float exit = w.velocity.y < 0 ? (w.position.y - config_.y_min) / -w.velocity.y : INFINITY;
+    if (w.position.y < config_.y_min || exit < config_.dwell) continue;
+    byExit.push_back(std::make_pair(exit, (int)i));
+  }
+  std::sort(byExit.begin(), byExit.end());
+
+  window_.clear();
+  for (size_t i = 0; i < byExit.size() && (int)window_.size() < config_.window; ++i) {
+    window_.push_back(weeds[byExit[i].second]);
+  }
+  used_.assign(window_.size(), false);
+  path_.clear();
+  expanded_ = 0;
+
+  // the last plan, with whatever of it still works, is the one to beat
+  std::vector<int> last;
+  last.swap(order_);
+  best_count_ = 0;
+  finish_ = 0;
+  float from[NUM_AXIES], t = 0;
+  std::copy(angles, angles + NUM_AXIES, from);
+  for (size_t k = 0; k < last.size() && best_count_ < config_.horizon; ++k) {
+    for (size_t i = 0; i < window_.size(); ++i) {
+      float to[NUM_AXIES], done;
+      if (window_[i].id != last[k] || !visit(window_[i], from, t, to, done)) continue;
+      order_.push_back(last[k]);
+      best_count_++;
+      finish_ = t = done;
+      std::copy(to, to + NUM_AXIES, from);
+    }
+  }
+
+  search(0, 0, 0, angles);
+  return order_;
+}
@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------------
+// Serial command queue, see commandQueue.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "commandQueue.h"
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+CommandQueue::CommandQueue(size_t capacity)
+  : capacity_(capacity), sent_(0), coalesced_(0), dropped_(0) {}
+
+/**
+ * There is never more than one latest-wins frame waiting, so the one to
+ * replace is the only one there is.  It is taken out rather than overwritten
+ * so the newer frame goes in behind whatever was pushed after it.
+ */
+bool CommandQueue::push(const uint8_t *frame, size_t size, bool latest_wins) {
+  if (size > SERIAL_FRAME_MAX_SIZE) return false;
+
+  if (latest_wins) {
+    for (std::deque<QueuedFrame>::iterator it = frames_.begin(); it != frames_.end(); ++it) {
+      if (!it->latest_wins) continue;
+      frames_.erase(it);
+      coalesced_++;
+      break;
+    }
+  }
+
+  if (frames_.size() >= capacity_) {
+    dropped_++;
+    return false;
+  }
+
+  frames_.push_back(QueuedFrame());
+  QueuedFrame &queued = frames_.back();
+  memcpy(queued.bytes, frame, size);
+  queued.size = size;
+  queued.latest_wins = latest_wins;
+  return true;
+}
+
+bool CommandQueue::pop(QueuedFrame &frame) {
+  if (frames_.empty()) return false;
+  frame = frames_.front();
+  frames_.pop_front();
+  sent_++;
+  return true;
+}
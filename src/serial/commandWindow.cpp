@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+// Commands in flight to the Teensy, see commandWindow.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "commandWindow.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+
+namespace {
+
+// How many of the last commands to end are remembered
+const size_t MAX_FINISHED = 32;
+
+// Acks that match nothing for this long are dropped (s)
+const double UNMATCHED_ACK_LIFETIME = 1.0;
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+const char *command_status_name(CommandStatus status) {
+  switch (status) {
+    case CMD_PENDING: return "still waiting for its ack";
+    case CMD_ACKED: return "acked";
+    case CMD_NACKED: return "failed on the Teensy";
+    case CMD_TIMED_OUT: return "timed out waiting for its ack";
+    case CMD_REPLACED: return "replaced by a later one";
+    case CMD_NEVER_SENT: return "never sent";
+    case CMD_EXPIRED: return "finished too long ago to tell";
+  }
+  return "unknown";
+}
+
+CommandWindow::CommandWindow(size_t size, int retries, double ack_timeout)
+  : size_(size), retries_(retries), ack_timeout_(ack_timeout), next_id_(1) {}
+
+std::deque<CommandWindow::Pending>::iterator CommandWindow::finish(std::deque<Pending>::iterator cmd,
+                                                                  CommandStatus status) {
+  finished_.push_back(std::make_pair(cmd->id, status));
+  if (finished_.size() > MAX_FINISHED) finished_.pop_front();
+  return in_flight_.erase(cmd);
+}
+
+/**
+ * A nacked command is left for due() to hand back
+ */
+void CommandWindow::resolve(std::deque<Pending>::iterator cmd, bool success) {
+  if (success) {
+    finish(cmd, CMD_ACKED);
+  } else {
+    cmd->nacked = true;
+  }
+}
+
+/**
+ * Its ack may have come in before the write's reply with the sequence
+ * number, acks too old to be its are dropped on the way
+ */
+void CommandWindow::claimAck(std::deque<Pending>::iterator cmd, double now) {
+  std::deque<UnmatchedAck>::iterator ack = unmatched_.begin();
+  while (ack != unmatched_.end()) {
+    if (now - ack->received > UNMATCHED_ACK_LIFETIME) {
+      ack = unmatched_.erase(ack);
+    } else if (ack->sequence == cmd->sequence && ack->type == cmd->type) {
+      bool success = ack->success;
+      unmatched_.erase(ack);
+      resolve(cmd, success);
+      return;
+    } else {
+      ++ack;
+    }
+  }
+}
+
+bool CommandWindow::makeRoom() {
+  if (in_flight_.size() < size_) return true;
+
+  // A replaced motor target is not worth waiting on
+  for (std::deque<Pending>::iterator cmd = in_flight_.begin(); cmd != in_flight_.end(); ++cmd) {
+    if (!cmd->superseded) continue;
+    finish(cmd, CMD_REPLACED);
+    return true;
+  }
+  return false;
+}
+
+unsigned CommandWindow::add(uint8_t sequence, int type, const std::string &bytes, bool latest_wins,
+                            double now, double expect) {
+  Pending cmd;
+  cmd.id = next_id_++;
+  if (next_id_ == 0) next_id_ = 1;
+  cmd.sequence = sequence;
+  cmd.type = type;
+  cmd.bytes = bytes;
+  cmd.sent = now;
+  cmd.expect = std::max(expect, 0.0);
+  cmd.retries = 0;
+  cmd.latest_wins = latest_wins;
+  cmd.nacked = false;
+  cmd.superseded = false;
+
+  // Only the latest one matters
+  if (latest_wins) {
+    for (size_t i = 0; i < in_flight_.size(); ++i) {
+      if (in_flight_[i].latest_wins) in_flight_[i].superseded = true;
+    }
+  }
+  in_flight_.push_back(cmd);
+  claimAck(in_flight_.end() - 1, now);
+  return cmd.id;
+}
+
+bool CommandWindow::ack(uint8_t sequence, int type, bool success, double now) {
+  for (std::deque<Pending>::iterator cmd = in_flight_.begin(); cmd != in_flight_.end(); ++cmd) {
+    if (cmd->sequence != sequence || cmd->type != type) continue;
+    resolve(cmd, success);
+    return true;
+  }
+
+  UnmatchedAck ack = {sequence, type, success, now};
+  unmatched_.push_back(ack);
+  return false;
+}
+
+/**
+ * A latest-wins command a later one has replaced is dropped instead of being
+ * written again: the arm is on its way to the later target, and going back
+ * to the old one would undo it.
+ */
+void CommandWindow::due(double now, std::vector<CommandResend> &resend, std::vector<unsigned> &failed) {
+  std::deque<Pending>::iterator cmd = in_flight_.begin();
+  while (cmd != in_flight_.end()) {
+    if (!cmd->nacked && now < cmd->sent + cmd->expect + ack_timeout_) {
+      ++cmd;
+    } else if (cmd->superseded) {
+      cmd = finish(cmd, CMD_REPLACED);
+    } else if (cmd->retries >= retries_) {
+      failed.push_back(cmd->id);
+      cmd = finish(cmd, cmd->nacked ? CMD_NACKED : CMD_TIMED_OUT);
+    } else {
+      CommandResend again = {cmd->id, cmd->bytes, cmd->nacked};
+      resend.push_back(again);
+      ++cmd;
+    }
+  }
+}
+
+void CommandWindow::resent(unsigned id, bool written, uint8_t sequence, double now) {
+  for (std::deque<Pending>::iterator cmd = in_flight_.begin(); cmd != in_flight_.end(); ++cmd) {
+    if (cmd->id != id) continue;
+    cmd->retries++;
+    cmd->nacked = false;
+    cmd->sent = now;
+    if (!written) return;
+    cmd->sequence = sequence;
+    claimAck(cmd, now);
+    return;
+  }
+}
+
+CommandStatus CommandWindow::status(unsigned id) const {
+  for (size_t i = 0; i < in_flight_.size(); ++i) {
+    if (in_flight_[i].id == id) return CMD_PENDING;
+  }
+  for (size_t i = 0; i < finished_.size(); ++i) {
+    if (finished_[i].first == id) return finished_[i].second;
+  }
+  // Never sent
+  if (id == 0 || id >= next_id_) return CMD_NEVER_SENT;
+  // Finished before the oldest one kept, failures included
+  return CMD_EXPIRED;
+}
+
+double CommandWindow::nextDue(double now) const {
+  double due = now + ack_timeout_;
+  for (size_t i = 0; i < in_flight_.size(); ++i) {
+    const Pending &cmd = in_flight_[i];
+    if (cmd.nacked) return now;
+    due = std::min(due, cmd.sent + cmd.expect + ack_timeout_);
+  }
+  return due;
+}
@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+// Serial link framing, see serialFrame.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "serialFrame.h"
+
+#include <algorithm>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+
+namespace {
+
+// CRC-16/CCITT-FALSE a byte at a time
+struct Crc16Table {
+  uint16_t entries[256];
+
+  Crc16Table() {
+    for (int i = 0; i < 256; ++i) {
+      uint16_t crc = (uint16_t)(i << 8);
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+      }
+      entries[i] = crc;
+    }
+  }
+};
+const Crc16Table crcTable;
+
+/**
+ * Whole frame size for a length byte, 0 if no frame is that long
+ */
+size_t frameSize(uint8_t length) {
+  return length > SERIAL_FRAME_MAX_PAYLOAD ? 0 : length + SERIAL_FRAME_OVERHEAD;
+}
+
+/**
+ * Check the size bytes at p (starting at a sync byte) as a frame
+ */
+bool parse(const uint8_t *p, size_t size, SerialFrame &frame) {
+  uint16_t crc = (uint16_t)(p[size - 2] | (p[size - 1] << 8));
+  if (serial_crc16(p + 1, size - 1 - SERIAL_FRAME_TRAILER) != crc) return false;
+
+  frame.length = p[1];
+  frame.sequence = p[2];
+  frame.payload = p + SERIAL_FRAME_HEADER;
+  return true;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+uint16_t serial_crc16(const uint8_t *data, size_t n, uint16_t crc) {
+  for (size_t i = 0; i < n; ++i) {
+    crc = (uint16_t)((crc << 8) ^ crcTable.entries[(crc >> 8) ^ data[i]]);
+  }
+  return crc;
+}
+
+size_t serial_frame_encode(uint8_t sequence, const void *payload, size_t length, uint8_t *out) {
+  if (length > SERIAL_FRAME_MAX_PAYLOAD) return 0;
+
+  out[0] = SERIAL_FRAME_SYNC;
+  out[1] = (uint8_t)length;
+  out[2] = sequence;
+  memcpy(out + SERIAL_FRAME_HEADER, payload, length);
+
+  uint16_t crc = serial_crc16(out + 1, length + 2);
+  out[SERIAL_FRAME_HEADER + length] = (uint8_t)(crc & 0xFF);
+  out[SERIAL_FRAME_HEADER + length + 1] = (uint8_t)(crc >> 8);
+  return length + SERIAL_FRAME_OVERHEAD;
+}
+
+SerialFrameDecoder::SerialFrameDecoder()
+  : have_(0), emitted_(0), frames_(0), rejected_(0), skipped_(0) {}
+
+void SerialFrameDecoder::reset() {
+  skipped_ += have_ - emitted_;
+  have_ = 0;
+  emitted_ = 0;
+}
+
+/**
+ * The frame in buf_ is bad: its sync byte was not the start of a frame, so
+ * start again from the next sync byte after it
+ */
+void SerialFrameDecoder::resync() {
+  size_t k = 1;
+  while (k < have_ && buf_[k] != SERIAL_FRAME_SYNC) ++k;
+  memmove(buf_, buf_ + k, have_ - k);
+  have_ -= k;
+  skipped_ += k;
+}
+
+size_t SerialFrameDecoder::decode(const uint8_t *data, size_t n, SerialFrame &frame, bool &complete) {
+  complete = false;
+  size_t used = 0;
+
+  if (emitted_ > 0) {
+    memmove(buf_, buf_ + emitted_, have_ - emitted_);
+    have_ -= emitted_;
+    emitted_ = 0;
+  }
+
+  // Finish the frame started in an earlier chunk (or what resyncing left behind)
+  while (have_ > 0) {
+    size_t need = have_ < 2 ? 2 : frameSize(buf_[1]);
+    if (need == 0) {
+      rejected_++;
+      resync();
+      continue;
+    }
+    if (have_ < need) {
+      if (used == n) return used;
+      size_t take = std::min(need - have_, n - used);
+      memcpy(buf_ + have_, data + used, take);
+      have_ += take;
+      used += take;
+      continue;
+    }
+    if (parse(buf_, need, frame)) {
+      emitted_ = need;
+      frames_++;
+      complete = true;
+      return used;
+    }
+    rejected_++;
+    resync();
+  }
+
+  // Then straight out of the caller's buffer
+  while (used < n) {
+    const uint8_t *p = data + used;
+    size_t left = n - used;
+    if (*p != SERIAL_FRAME_SYNC) {
+      const void *sync = memchr(p, SERIAL_FRAME_SYNC, left);
+      size_t skip = sync ? (size_t)((const uint8_t *)sync - p) : left;
+      skipped_ += skip;
+      used += skip;
+      continue;
+    }
+
+    size_t need = left < 2 ? 2 : frameSize(p[1]);
+    if (need == 0) {
+      rejected_++;
+      skipped_++;
+      used++;
+      continue;
+    }
+    if (left < need) {
+      memcpy(buf_, p, left);
+      have_ = left;
+      return n;
+    }
+    if (parse(p, need, frame)) {
+      frames_++;
+      complete = true;
+      return used + need;
+    }
+    // that sync byte was part of something else
+    rejected_++;
+    skipped_++;
+    used++;
+  }
+  return used;
+}
@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+// Serial port I/O loop, see serialIoLoop.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// INCLUDES
+//------------------------------------------------------------------------------
+#include "serialIoLoop.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Start, 8 data and stop bit
+const int BITS_PER_BYTE = 10;
+
+const size_t READ_CHUNK = 512;
+
+speed_t baudSpeed(int baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 500000: return B500000;
+    case 921600: return B921600;
+    default: return B0;
+  }
+}
+
+bool watch(int epoll_fd, int op, int fd, uint32_t events) {
+  epoll_event event = {};
+  event.events = events;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, op, fd, &event) == 0;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+// METHODS
+//------------------------------------------------------------------------------
+
+int serial_port_open(const char *path, int baud) {
+  speed_t speed = baudSpeed(baud);
+  if (speed == B0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) return -1;
+
+  termios tio;
+  if (tcgetattr(fd, &tio) < 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+
+  // Nothing left over from before we opened it
+  tcflush(fd, TCIOFLUSH);
+  return fd;
+}
+
+SerialIoLoop::SerialIoLoop(int fd, int baud, size_t queue_capacity, const ReadHandler &on_read)
+  : fd_(fd), byte_time_((double)BITS_PER_BYTE / baud), on_read_(on_read), stop_(false),
+    queue_(queue_capacity), written_(0), writing_(false), draining_(false), watching_out_(false) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (!ok()) return;
+
+  if (!watch(epoll_fd_, EPOLL_CTL_ADD, fd_, EPOLLIN) || !watch(epoll_fd_, EPOLL_CTL_ADD, event_fd_, EPOLLIN) ||
+      !watch(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, EPOLLIN)) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+}
+
+SerialIoLoop::~SerialIoLoop() {
+  if (epoll_fd_ >= 0) close(epoll_fd_);
+  if (event_fd_ >= 0) close(event_fd_);
+  if (timer_fd_ >= 0) close(timer_fd_);
+}
+
+bool SerialIoLoop::send(const uint8_t *frame, size_t size, bool latest_wins) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (!queue_.push(frame, size, latest_wins)) return false;
+  }
+  wake();
+  return true;
+}
+
+void SerialIoLoop::stop() {
+  stop_ = true;
+  wake();
+}
+
+void SerialIoLoop::wake() {
+  uint64_t one = 1;
+  ssize_t n = write(event_fd_, &one, sizeof(one));
+  (void)n;
+}
+
+unsigned long SerialIoLoop::sent() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.sent();
+}
+
+unsigned long SerialIoLoop::coalesced() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.coalesced();
+}
+
+unsigned long SerialIoLoop::dropped() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.dropped();
+}
+
+bool SerialIoLoop::watchWritable(bool writable) {
+  if (writable == watching_out_) return true;
+  watching_out_ = writable;
+  return watch(epoll_fd_, EPOLL_CTL_MOD, fd_, writable ? EPOLLIN | EPOLLOUT : EPOLLIN);
+}
+
+bool SerialIoLoop::readPort() {
+  uint8_t buf[READ_CHUNK];
+  for (;;) {
+    ssize_t n = read(fd_, buf, sizeof(buf));
+    if (n > 0) {
+      on_read_(buf, (size_t)n);
+      continue;
+    }
+    if (n == 0 || errno == EAGAIN || errno == EWOULDBLOCK) return true;
+    if (errno != EINTR) return false;
+  }
+}
+
+/**
+ * The bytes still in the driver's buffer have to go out before the next
+ * frame is taken off the queue.  Not a tty (nothing to wait for) if the
+ * driver can't say.
+ */
+bool SerialIoLoop::drainAfterWrite() {
+  int queued = 0;
+  if (ioctl(fd_, TIOCOUTQ, &queued) < 0 || queued <= 0) return true;
+
+  double wait = queued * byte_time_;
+  itimerspec due = {};
+  due.it_value.tv_sec = (time_t)wait;
+  due.it_value.tv_nsec = std::max(1L, (long)((wait - floor(wait)) * 1e9));
+  if (timerfd_settime(timer_fd_, 0, &due, NULL) < 0) return false;
+  draining_ = true;
+  return true;
+}
+
+/**
+ * Write frames until the queue is empty, the port is full or a frame is
+ * still going out
+ */
+bool SerialIoLoop::writePort() {
+  while (!draining_) {
+    if (!writing_) {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (!queue_.pop(frame_)) break;
+      written_ = 0;
+      writing_ = true;
+    }
+
+    while (written_ < frame_.size) {
+      ssize_t n = write(fd_, frame_.bytes + written_, frame_.size - written_);
+      if (n >= 0) {
+        written_ += n;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return watchWritable(true);
+      } else if (errno != EINTR) {
+        return false;
+      }
+    }
+    writing_ = false;
+    if (!drainAfterWrite()) return false;
+  }
+  return watchWritable(false);
+}
+
+bool SerialIoLoop::run() {
+  if (!ok()) return false;
+
+  epoll_event events[4];
+  while (!stop_) {
+    if (!writePort()) return false;
+
+    int n = epoll_wait(epoll_fd_, events, 4, -1);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      uint64_t count;
+      if (events[i].data.fd == event_fd_) {
+        // the queue has something, or we're stopping: both seen at the top of the loop
+        ssize_t r = read(event_fd_, &count, sizeof(count));
+        (void)r;
+      } else if (events[i].data.fd == timer_fd_) {
+        ssize_t r = read(timer_fd_, &count, sizeof(count));
+        (void)r;
+        // whatever is left of it has gone out by now, or the wait is timed again
+        draining_ = false;
+        if (!drainAfterWrite()) return false;
+      } else {
+        if (events[i].events & EPOLLIN) {
+          if (!readPort()) return false;
+        }
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+          errno = EIO;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
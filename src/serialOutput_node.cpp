@@ -1,26 +1,65 @@
 #include <ros/ros.h>
-#include <serial/serial.h>
 #include <std_msgs/String.h>
 #include <std_msgs/Empty.h>
 
 // Shared lib
 #include "SerialPacket.h"
+#include "serialFrame.h"
+#include "serialIoLoop.h"
+#include "spscRing.h"
 
 // Srv and msg types
 #include <urGovernor/SerialWrite.h>
 #include <urGovernor/SerialRead.h>
+#include <urGovernor/CmdAck.h>
+#include <urGovernor/SerialStats.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
 
 // Parameters to read from configs
 std::string serialServiceWriteName;
 std::string serialServiceReadName;
+std::string serialAckTopic;
 std::string serialPort;
 int serialBaudRate;
-int serialTimeoutMs;
+float statsLogInterval;
+std::string serialStatsTopic;
+
+// The port, run by its own I/O thread (see serialIoLoop.h); ROS callbacks are served on
+// another
+int serialFd = -1;
+std::unique_ptr<SerialIoLoop> ioLoop;
+
+// Every command goes out framed, numbered in the order it was sent
+uint8_t sendSequence = 0;
+
+// Commands waiting to be written: a motor target replaces the one still waiting, if there
+// is one (see commandQueue.h)
+const size_t writeQueueSize = 64;
+
+// Frames coming in, only touched on the I/O thread
+SerialFrameDecoder decoder;
+
+// For the stats
+std::atomic<unsigned> acksRead(0);
+std::atomic<unsigned long> framesRejected(0);
+ros::Publisher statsPublisher;
+
+// Acks as they come in, for the SerialRead service: the I/O thread is its only producer
+// and the service its only consumer
+SpscRing<SerialUtils::CmdMsg, 256> ackRing;
+std::atomic<bool> ackRingRead(false);
+std::atomic<unsigned> acksDropped(0);
 
-// Serial output instance
-serial::Serial ser;
+// Every ack is also published the moment it is read
+ros::Publisher ackPublisher;
 
 // Serial Write service (called by controller to send motor angles)
 bool serialWrite(urGovernor::SerialWrite::Request &req, urGovernor::SerialWrite::Response &res)
@@ -33,42 +72,127 @@ bool serialWrite(urGovernor::SerialWrite::Request &req, urGovernor::SerialWrite:
     SerialUtils::unpack(v, cmdMsg);
 
     ROS_DEBUG_STREAM("Writing to serial: " << std::endl << std::string(cmdMsg));
-    
-    // Send over serial
-    ser.write(string_msg);
+
+    uint8_t frame[SERIAL_FRAME_MAX_SIZE];
+    size_t size = serial_frame_encode(sendSequence, string_msg.data(), string_msg.size(), frame);
+    if (size == 0)
+    {
+        ROS_ERROR("Command of %zu bytes is too long to frame", string_msg.size());
+        res.status = -1;
+        return true;
+    }
+
+    // Queued for the I/O thread
+    if (!ioLoop->send(frame, size, cmdMsg.cmd_type == SerialUtils::CMDTYPE_MTRS))
+    {
+        ROS_ERROR_THROTTLE(1.0, "Serial write queue is full, command dropped");
+        res.status = -1;
+        return true;
+    }
+    res.sequence = sendSequence++;
     res.status = 0;
 
     return true;
 }
 
-// Serial Read service (called by controller to sychronize end of motor movement)
+// Serial Read service: the oldest ack not read yet (false if there is none)
 bool serialRead(urGovernor::SerialRead::Request &req, urGovernor::SerialRead::Response &res)
 {
-    bool retValue = false;
+    ackRingRead = true;
 
-    while (ser.available())
+    SerialUtils::CmdMsg cmdMsg;
+    if (!ackRing.pop(cmdMsg))
     {
-        std::string response = ser.readline();
+        return false;
+    }
 
-        // If return string was too small
-        if (response.length() < sizeof(SerialUtils::CmdMsg))
-        {
+    std::vector<char> v;
+    SerialUtils::pack(v, cmdMsg);
+    res.command = std::string(v.begin(), v.end());
+
+    return true;
+}
+
+// A complete ack from the Teensy, numbered as the command it acks
+void onAck(const SerialUtils::CmdMsg& cmdMsg, uint8_t sequence)
+{
+    ROS_DEBUG_STREAM("Reading from serial: " << std::endl << std::string(cmdMsg));
+
+    std::vector<char> v;
+    SerialUtils::pack(v, cmdMsg);
+
+    urGovernor::CmdAck ack;
+    ack.stamp = ros::Time::now();
+    ack.sequence = sequence;
+    ack.command = std::string(v.begin(), v.end());
+    ackPublisher.publish(ack);
+    acksRead++;
+
+    // Only counts once someone reads them
+    if (!ackRing.push(cmdMsg) && ackRingRead)
+    {
+        acksDropped++;
+        ROS_WARN_THROTTLE(10.0, "SerialRead is behind, %u acks dropped", (unsigned)acksDropped);
+    }
+}
+
+/* I/O thread: decodes the frames that come in, each holding a packed CmdMsg, as soon as they arrive
+ *      A frame split across reads is carried over to the next, and a corrupted one is dropped without
+ *      taking the ones after it along.
+ */
+void onSerialData(const uint8_t* data, size_t n)
+{
+    unsigned long rejected = decoder.rejected();
+
+    size_t used = 0;
+    while (used < n)
+    {
+        SerialFrame frame;
+        bool complete;
+        used += decoder.decode(data + used, n - used, frame, complete);
+        if (!complete)
             continue;
-        }
 
-        res.command = response;
-        std::vector<char> v(res.command.begin(), res.command.end());
+        // Anything but a command is not an ack
+        if (frame.length != sizeof(SerialUtils::CmdMsg))
+            continue;
         SerialUtils::CmdMsg cmdMsg;
-        // Unpack response from read
-        SerialUtils::unpack(v, cmdMsg);
+        memcpy(&cmdMsg, frame.payload, sizeof(cmdMsg));
+        onAck(cmdMsg, frame.sequence);
+    }
 
-        ROS_DEBUG_STREAM("Reading from serial: " << std::endl << std::string(cmdMsg));
+    if (decoder.rejected() != rejected)
+    {
+        framesRejected = decoder.rejected();
+        ROS_WARN_THROTTLE(10.0, "%lu corrupted serial frames dropped", decoder.rejected());
+    }
+}
 
-        retValue = true;
+// I/O thread: runs the port until shutdown
+void runSerial()
+{
+    if (!ioLoop->run())
+    {
+        ROS_ERROR("Serial port failed: %s", strerror(errno));
+        ros::requestShutdown();
     }
-    
-    // Otherwise we timed out!
-    return retValue;
+}
+
+// Log and publish the link counters
+void logStats(const ros::WallTimerEvent&)
+{
+    urGovernor::SerialStats stats;
+    stats.sent = ioLoop->sent();
+    stats.coalesced = ioLoop->coalesced();
+    stats.dropped = ioLoop->dropped();
+    stats.acks = acksRead;
+    stats.frames_rejected = framesRejected;
+
+    ROS_INFO("Serial -- %u commands sent, %u replaced by a newer target, %u dropped; %u acks, %u bad frames",
+        stats.sent, stats.coalesced, stats.dropped, stats.acks, stats.frames_rejected);
+
+    stats.header.stamp = ros::Time::now();
+    statsPublisher.publish(stats);
 }
 
 // General parameters for this node
@@ -76,11 +200,13 @@ bool readGeneralParameters(ros::NodeHandle nodeHandle)
 {
     if (!nodeHandle.getParam("serial_output_service", serialServiceWriteName)) return false;
     if (!nodeHandle.getParam("serial_input_service", serialServiceReadName)) return false;
+    if (!nodeHandle.getParam("serial_ack_topic", serialAckTopic)) return false;
     
     if (!nodeHandle.getParam("serial_port", serialPort)) return false;
     if (!nodeHandle.getParam("serial_baud_rate", serialBaudRate)) return false;
 
-    if (!nodeHandle.getParam("serial_timeout_ms", serialTimeoutMs)) return false;
+    if (!nodeHandle.getParam("stats_log_interval_s", statsLogInterval)) return false;
+    if (!nodeHandle.getParam("serial_stats_topic", serialStatsTopic)) return false;
 
     return true;
 }
@@ -97,30 +223,19 @@ int main(int argc, char** argv)
     }
 
     // Setting up serial ...
-    try
-    {
-        ser.setPort(serialPort);
-        ser.setBaudrate(serialBaudRate);
-	    ser.setBytesize(serial::eightbits);
-	    ser.setFlowcontrol(serial::flowcontrol_none);
-	    ser.setParity(serial::parity_none);
-	    ser.setStopbits(serial::stopbits_one);
-        serial::Timeout to = serial::Timeout::simpleTimeout(serialTimeoutMs);
-        ser.setTimeout(to);
-        ser.open();
-    }
-    catch (serial::IOException& e)
+    serialFd = serial_port_open(serialPort.c_str(), serialBaudRate);
+    if (serialFd < 0)
     {
-        ROS_ERROR("Unable to open port ");
+        ROS_ERROR("Unable to open port %s: %s", serialPort.c_str(), strerror(errno));
         return -1;
     }
-
-    if(ser.isOpen()){
-        ser.flush();
-        ROS_INFO("Serial Port initialized");
-    }else{
+    ioLoop.reset(new SerialIoLoop(serialFd, serialBaudRate, writeQueueSize, onSerialData));
+    if (!ioLoop->ok())
+    {
+        ROS_ERROR("Unable to set up serial I/O: %s", strerror(errno));
         return -1;
     }
+    ROS_INFO("Serial Port initialized");
 
     // Service to write to serial
     ros::ServiceServer writeService = nodeHandle.advertiseService(serialServiceWriteName, serialWrite);
@@ -128,6 +243,25 @@ int main(int argc, char** argv)
     // Service to read from serial
     ros::ServiceServer readService = nodeHandle.advertiseService(serialServiceReadName, serialRead);
 
-    ros::spin();
+    // Acks as they come in
+    ackPublisher = nodeHandle.advertise<urGovernor::CmdAck>(serialAckTopic, 64);
+
+    // Write queue counters
+    statsPublisher = nodeHandle.advertise<urGovernor::SerialStats>(serialStatsTopic, 1);
+    ros::WallTimer statsTimer = nodeHandle.createWallTimer(ros::WallDuration(statsLogInterval), logStats);
+
+    // Services and the stats timer on their own thread, so neither direction of the port
+    // waits on them
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    std::thread io(runSerial);
+    ros::waitForShutdown();
+    ioLoop->stop();
+    io.join();
+    spinner.stop();
+
+    ioLoop.reset();
+    close(serialFd);
 }
 
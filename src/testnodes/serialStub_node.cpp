@@ -9,11 +9,27 @@
 // Srv and msg types
 #include <urGovernor/SerialWrite.h>
 #include <urGovernor/SerialRead.h>
+#include <urGovernor/CmdAck.h>
+
+#include <deque>
 using namespace std;
 
 // Parameters to read from configs
 std::string serialServiceWriteName;
 std::string serialServiceReadName;
+std::string serialAckTopic;
+
+// Every write is acked (successfully) this long after, as if the motors took that long
+const double ackDelay = 0.5;
+ros::Publisher ackPublisher;
+struct PendingAck
+{
+    ros::WallTime due;
+    uint8_t sequence;
+    SerialUtils::CmdMsg msg;
+};
+std::deque<PendingAck> pendingAcks;
+uint8_t sendSequence = 0;
 
 // Serial Write service (called by controller to send motor angles)
 bool serialWrite(urGovernor::SerialWrite::Request &req, urGovernor::SerialWrite::Response &res)
@@ -25,9 +41,33 @@ bool serialWrite(urGovernor::SerialWrite::Request &req, urGovernor::SerialWrite:
 
     ROS_DEBUG_STREAM("Writing to serial: " << std::endl << std::string(msg));
 
+    msg.cmd_success = 1;
+    PendingAck ack = {ros::WallTime::now() + ros::WallDuration(ackDelay), sendSequence, msg};
+    pendingAcks.push_back(ack);
+    res.sequence = sendSequence++;
+
     return true;
 }
 
+// Publish the acks that are due, the way serialOutput does as they come in
+void publishAcks(const ros::WallTimerEvent&)
+{
+    ros::WallTime now = ros::WallTime::now();
+    while (!pendingAcks.empty() && pendingAcks.front().due <= now)
+    {
+        std::vector<char> buff;
+        SerialUtils::pack(buff, pendingAcks.front().msg);
+
+        urGovernor::CmdAck ack;
+        ack.stamp = ros::Time::now();
+        ack.sequence = pendingAcks.front().sequence;
+        ack.command = std::string(buff.begin(), buff.end());
+        ackPublisher.publish(ack);
+
+        pendingAcks.pop_front();
+    }
+}
+
 // Serial Read service (called by controller to sychronize end of motor movement)
 bool serialRead(urGovernor::SerialRead::Request &req, urGovernor::SerialRead::Response &res)
 {
@@ -51,6 +91,7 @@ bool readGeneralParameters(ros::NodeHandle nodeHandle)
 {
     if (!nodeHandle.getParam("serial_output_service", serialServiceWriteName)) return false;
     if (!nodeHandle.getParam("serial_input_service", serialServiceReadName)) return false;
+    if (!nodeHandle.getParam("serial_ack_topic", serialAckTopic)) return false;
 
     return true;
 }
@@ -72,6 +113,9 @@ int main(int argc, char** argv)
     // Service to read from serial
     ros::ServiceServer readService = nodeHandle.advertiseService(serialServiceReadName, serialRead);
 
+    ackPublisher = nodeHandle.advertise<urGovernor::CmdAck>(serialAckTopic, 64);
+    ros::WallTimer ackTimer = nodeHandle.createWallTimer(ros::WallDuration(0.01), publishAcks);
+
     ros::spin();
 }
 
@@ -1,34 +1,71 @@
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 
 // Shared lib
 #include "SerialPacket.h"
 
 // For kinematics
 #include "deltaRobot.h"
+#include "deltaFrame.h"
+#include "deltaLookupTable.h"
+#include "deltaReachability.h"
+#include "deltaTrajectory.h"
+#include "weedPredictor.h"
+#include "weedScheduler.h"
+#include "weedAssigner.h"
+#include "armFootprint.h"
+#include "armCycle.h"
+#include "commandWindow.h"
 
 // Srv and msg types
 #include <urGovernor/FetchWeed.h>
 #include <urGovernor/MarkUprooted.h>
 #include <urGovernor/RemoveWeed.h>
+#include <urGovernor/CheckReachable.h>
+#include <urGovernor/TrackedWeedArray.h>
+#include <urGovernor/GovernorStats.h>
 
 #include <urVision/weedDataArray.h>
 #include <urGovernor/SerialWrite.h>
-#include <urGovernor/SerialRead.h>
+#include <urGovernor/CmdAck.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Vector3.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 // Parameters to read from configs
 std::string fetchWeedServiceName;
 std::string markUprootedServiceName;
 std::string rmWeedServiceName;
+std::string reachabilityServiceName;
+
+// Take the tracker's weeds from a published stream instead of fetching them
+bool trackStreamEnable;
+std::string trackStreamTopic;
+
+// Order the streamed weeds ourselves rather than take the tracker's top valid one
+bool schedulerEnable;
+int schedulerWindow;
+int schedulerHorizon;
+
+// Arms on the implement, sharing the weeds (see ArmContext)
+int armCount;
+float armClearance;
+std::unique_ptr<WeedAssigner> weedAssigner;
 
 float overallRate;
 
-std::string serialServiceWriteName;
-std::string serialServiceReadName;
 std::string velocityPublisherName;
 
-int restAngle1, restAngle2, restAngle3;
 float cartesianLimitXMax, cartesianLimitXMin, cartesianLimitYMax, cartesianLimitYMin;
 float angleLimit;
 
@@ -42,27 +79,83 @@ const int relativeAngleFlag = false;
 float toolOffset;
 float soilOffset;
 float targetYGain;
-float curYVel;
+std::atomic<float> curYVel(0);
+std::atomic<double> curYVelStamp(0);
+
+// Aim at where the weed will be when the arm arrives (replaces target_y_gain and the feed-forward)
+bool predictorEnable;
+WeedPredictorNoise predictorNoise;
+
+// Warm-started IK while tracking a weed (0 to disable)
+float incrementalIkTolerance;
+
+// Joint-rate feed-forward from the tracker velocity
+bool feedForwardEnable;
+float feedForwardMaxLead;
+
+// Precomputed IK over the workspace
+bool ikLutEnable;
+std::string ikLutPath;
+float ikLutResolution;
+float ikLutMaxError;
+
+// Measurements of this arm build
+DeltaGeometry armGeometry;
+
+// Height of the workspace above the soil covered by the precomputed tables
+float workspaceHeight;
+
+// Reachability pre-filter
+float reachabilityResolution;
+float reachabilityMinMargin;
 
 // Time to actuate end-effector
 double endEffectorTime = 0;
-bool endEffectorRunning = true;
-bool armDown = false;
 float stayDownDist = 0;
 
-// Connections to Serial interface services
-ros::ServiceClient serialWriteClient;
-ros::ServiceClient serialReadClient;
+// Connections to the tracker's services
 ros::ServiceClient fetchWeedClient;
 ros::ServiceClient markUprootedClient;
 ros::ServiceClient rmWeedClient;
 
 const int logFetchWeedInterval = 5;
 
-int serialTimeoutMs;
 int commandTimeoutSec;
+// Commands out to the Teensy at once, and how long past when one should be done it is
+// resent (up to commandRetries times)
+int commandWindow;
+float commandAckTimeout;
+int commandRetries;
 int motorSpeedDegS;
 int motorAccelDegSS;
+float motorJerkDegSSS;
+
+// Moves are timed to know when the arm gets there, treated as there this long after
+float arrivalMarginS;
+float endEffectorSpinupS;
+
+// Weeds/minute and detection-to-command latency are logged this often
+float statsLogInterval;
+std::string statsTopic;
+ros::Publisher statsPublisher;
+
+// Skip weeds that will leave the workspace before the arm can finish them
+bool admissionEnable;
+
+// Line up the next weed while the end effector works on the current one
+bool prepositionEnable;
+
+// Between weeds too far apart to stay down for, wait above the next one instead of at rest
+bool hoverEnable;
+float hoverClearance;
+
+// Come up only as far as it takes to keep the arm out of the camera's view of where new
+// weeds are detected (tracker frame)
+bool occlusionEnable;
+Vector3 cameraPosition;
+std::vector<GroundRect> detectionRegions;
+float armLinkRadius;
+float occlusionStep;
 
 // General parameters for this node
 bool readGeneralParameters(ros::NodeHandle nodeHandle)
@@ -70,6 +163,14 @@ bool readGeneralParameters(ros::NodeHandle nodeHandle)
     if (!nodeHandle.getParam("fetch_weed_service", fetchWeedServiceName)) return false;
     if (!nodeHandle.getParam("mark_uprooted_service", markUprootedServiceName)) return false;
     if (!nodeHandle.getParam("remove_weed_service", rmWeedServiceName)) return false;
+    if (!nodeHandle.getParam("reachability_service", reachabilityServiceName)) return false;
+    if (!nodeHandle.getParam("track_stream_enable", trackStreamEnable)) return false;
+    if (!nodeHandle.getParam("track_stream_topic", trackStreamTopic)) return false;
+    if (!nodeHandle.getParam("scheduler_enable", schedulerEnable)) return false;
+    if (!nodeHandle.getParam("scheduler_window", schedulerWindow)) return false;
+    if (!nodeHandle.getParam("scheduler_horizon", schedulerHorizon)) return false;
+    if (!nodeHandle.getParam("arm_count", armCount)) return false;
+    if (!nodeHandle.getParam("arm_clearance_cm", armClearance)) return false;
 
     if (!nodeHandle.getParam("velocity_publisher", velocityPublisherName)) return false;
    
@@ -79,10 +180,6 @@ bool readGeneralParameters(ros::NodeHandle nodeHandle)
     if (!nodeHandle.getParam("min_update_angle", minUpdateAngle)) return false;
     if (!nodeHandle.getParam("max_update_angle", maxUpdateAngle)) return false;
 
-    if (!nodeHandle.getParam("rest_angle_1", restAngle1)) return false;
-    if (!nodeHandle.getParam("rest_angle_2", restAngle2)) return false;
-    if (!nodeHandle.getParam("rest_angle_3", restAngle3)) return false;
-
     if (!nodeHandle.getParam("cartesian_limit_x_max", cartesianLimitXMax)) return false;
     if (!nodeHandle.getParam("cartesian_limit_x_min", cartesianLimitXMin)) return false;
     if (!nodeHandle.getParam("cartesian_limit_y_max", cartesianLimitYMax)) return false;
@@ -96,119 +193,593 @@ bool readGeneralParameters(ros::NodeHandle nodeHandle)
     if (!nodeHandle.getParam("tool_offset", toolOffset)) return false;
     if (!nodeHandle.getParam("soil_offset", soilOffset)) return false;
     if (!nodeHandle.getParam("target_y_gain", targetYGain)) return false;
+    if (!nodeHandle.getParam("feed_forward_enable", feedForwardEnable)) return false;
+    if (!nodeHandle.getParam("feed_forward_max_lead_s", feedForwardMaxLead)) return false;
+    if (!nodeHandle.getParam("predictor_enable", predictorEnable)) return false;
+    if (!nodeHandle.getParam("predictor_position_noise_cm", predictorNoise.position)) return false;
+    if (!nodeHandle.getParam("predictor_velocity_noise_cm_s", predictorNoise.velocity)) return false;
+    if (!nodeHandle.getParam("predictor_accel_noise_cm_s_s", predictorNoise.accel)) return false;
 
-    if (!nodeHandle.getParam("serial_output_service", serialServiceWriteName)) return false;
-    if (!nodeHandle.getParam("serial_input_service", serialServiceReadName)) return false;
-
-    if (!nodeHandle.getParam("serial_timeout_ms", serialTimeoutMs)) return false;
     if (!nodeHandle.getParam("command_timeout_sec", commandTimeoutSec)) return false;
+    if (!nodeHandle.getParam("command_window", commandWindow)) return false;
+    if (!nodeHandle.getParam("command_ack_timeout_s", commandAckTimeout)) return false;
+    if (!nodeHandle.getParam("command_retries", commandRetries)) return false;
 
     if (!nodeHandle.getParam("motor_speed_deg_s", motorSpeedDegS)) return false;
     if (!nodeHandle.getParam("motor_accel_deg_s_s", motorAccelDegSS)) return false;
+    if (!nodeHandle.getParam("motor_jerk_deg_s_s_s", motorJerkDegSSS)) return false;
+    if (!nodeHandle.getParam("arrival_margin_s", arrivalMarginS)) return false;
+    if (!nodeHandle.getParam("end_effector_spinup_s", endEffectorSpinupS)) return false;
+    if (!nodeHandle.getParam("stats_log_interval_s", statsLogInterval)) return false;
+    if (!nodeHandle.getParam("stats_topic", statsTopic)) return false;
+    if (!nodeHandle.getParam("admission_enable", admissionEnable)) return false;
+    if (!nodeHandle.getParam("preposition_enable", prepositionEnable)) return false;
+    if (!nodeHandle.getParam("hover_enable", hoverEnable)) return false;
+    if (!nodeHandle.getParam("hover_clearance_cm", hoverClearance)) return false;
+    if (!nodeHandle.getParam("occlusion_enable", occlusionEnable)) return false;
+    if (!nodeHandle.getParam("camera_x_cm", cameraPosition.x)) return false;
+    if (!nodeHandle.getParam("camera_y_cm", cameraPosition.y)) return false;
+    if (!nodeHandle.getParam("camera_height_cm", cameraPosition.z)) return false;
+    GroundRect detectionRegion;
+    if (!nodeHandle.getParam("detection_region_x_min", detectionRegion.x_min)) return false;
+    if (!nodeHandle.getParam("detection_region_x_max", detectionRegion.x_max)) return false;
+    if (!nodeHandle.getParam("detection_region_y_min", detectionRegion.y_min)) return false;
+    if (!nodeHandle.getParam("detection_region_y_max", detectionRegion.y_max)) return false;
+    detectionRegions.assign(1, detectionRegion);
+    if (!nodeHandle.getParam("arm_link_radius_cm", armLinkRadius)) return false;
+    if (!nodeHandle.getParam("occlusion_step_cm", occlusionStep)) return false;
+
+    if (!nodeHandle.getParam("ik_lut_enable", ikLutEnable)) return false;
+    if (!nodeHandle.getParam("ik_lut_path", ikLutPath)) return false;
+    if (!nodeHandle.getParam("ik_lut_resolution_cm", ikLutResolution)) return false;
+    if (!nodeHandle.getParam("workspace_height_cm", workspaceHeight)) return false;
+    if (!nodeHandle.getParam("arm_center_to_shoulder_cm", armGeometry.center_to_shoulder)) return false;
+    if (!nodeHandle.getParam("arm_shoulder_to_elbow_cm", armGeometry.shoulder_to_elbow)) return false;
+    if (!nodeHandle.getParam("arm_elbow_to_wrist_cm", armGeometry.elbow_to_wrist)) return false;
+    if (!nodeHandle.getParam("arm_effector_to_wrist_cm", armGeometry.effector_to_wrist)) return false;
+    if (!nodeHandle.getParam("arm_center_to_floor_cm", armGeometry.center_to_floor)) return false;
+    if (!nodeHandle.getParam("ik_lut_max_error_deg", ikLutMaxError)) return false;
+    if (!nodeHandle.getParam("incremental_ik_tolerance_cm", incrementalIkTolerance)) return false;
+    if (!nodeHandle.getParam("reachability_resolution_cm", reachabilityResolution)) return false;
+    if (!nodeHandle.getParam("reachability_min_margin_deg", reachabilityMinMargin)) return false;
    
     return true;
 }
 
-// Send CmdMsg over serial
-bool sendCmd(SerialUtils::CmdMsg msg)
+// End effector command waiting on its ack
+struct EndEffectorCommand
 {
-    urGovernor::SerialWrite serialWrite;
-    // Pack message
-    std::vector<char> buff;
-    SerialUtils::pack(buff, msg);
+    bool pending;
+    SerialUtils::CmdMsg msg;
+    unsigned id;
+    ros::WallTime sent;
+};
+
+/* What the arm's state machine (ArmCycle) is working on
+ *  Each arm runs its own, and only its worker thread touches it.  Tracker fetches and
+ *  serial acks run on their own threads and arrive as events, so each step works on the
+ *  freshest weed position without waiting on either.
+ */
+struct ArmTask
+{
+    // Weed being worked on
+    int trackingID;
+    int oldAngles[NUM_AXIES];
+    DeltaIncrementalState ikState;
+    int updatesSent;
 
-    serialWrite.request.command = std::string(buff.begin(), buff.end());
+    // Last move, for its ack
+    unsigned lastCmd;
 
-    // Send angles to HAL (via calling the serial WRITE client)
-    return serialWriteClient.call(serialWrite);
+    // Previous weed, to decide whether to stay down
+    geometry_msgs::Point lastWeed;
+};
+
+// Weed lined up during the dwell, started on as soon as the arm is free (see prepareNextWeed())
+struct NextWeed
+{
+    bool ready;
+    urGovernor::FetchWeed fetch;
+    ros::Time received;
+    // Solved for where it will be by then, so tracking it starts incremental
+    DeltaIncrementalState ikState;
+};
+
+/* One delta arm on the implement
+ *      Each has its own serial link (a serialOutput node), kinematics instance, tables and
+ *      mounting, and runs its state machine on its own worker thread.  The arms share the
+ *      tracker, the weed predictors and the stats.
+ */
+struct ArmContext
+{
+    ArmContext()
+        : index(0), endEffectorRunning(true), armDown(false), hovering(false), fetchRequestId(-1), fetchNext(false),
+          lastIDOutOfRange(-1), fetchWeedLogs(0)
+    {
+        std::fill(armTarget, armTarget + NUM_AXIES, 0);
+        endEffectorCmd.pending = false;
+        task.trackingID = -1;
+        task.lastCmd = 0;
+        task.updatesSent = 0;
+        next.ready = false;
+        slot.held = -1;
+        slot.free = 0;
+    }
+
+    int index;
+
+    // Where its delta frame origin sits in the tracker frame (cm); the cartesian limits
+    // are around it
+    float mountX, mountY;
+    int restAngles[NUM_AXIES];
+
+    // Serial interface: commands go out through its service, acks come back on its topic
+    std::string serialWriteName;
+    std::string serialAckTopic;
+    ros::ServiceClient serialWriteClient;
+    ros::Subscriber ackSubscriber;
+
+    std::unique_ptr<DeltaKinematics> kinematics;
+    DeltaLookupTable ikTable;
+    DeltaReachability reachMap;
+    // Move timing and workspace, for the scheduler and the assignment (track stream only)
+    std::unique_ptr<WeedScheduler> scheduler;
+    // What it hides from the camera (occlusion_enable only)
+    std::unique_ptr<ArmFootprint> footprint;
+
+    // Commands in flight to the Teensy (ackMutex)
+    std::unique_ptr<CommandWindow> commands;
+    std::mutex ackMutex;
+    std::condition_variable ackReceived;
+
+    // Timing of the last commanded move, to know when the arm gets there
+    DeltaTrajectory armMotion;
+    ros::WallTime armMotionStart;
+    float armTarget[NUM_AXIES];
+    bool endEffectorRunning;
+    EndEffectorCommand endEffectorCmd;
+    bool armDown;
+    // Holding a hover pose, off the soil but not at rest (see hoverAngles())
+    bool hovering;
+
+    std::unique_ptr<ArmCycle> cycle;
+    ArmTask task;
+    // Weed the tracker thread fetches: the one being worked on, or -1 for the top valid one
+    std::atomic<int> fetchRequestId;
+
+    NextWeed next;
+    // Have the tracker thread fetch a weed to line up (once per dwell, without the stream)
+    std::atomic<bool> fetchNext;
+
+    // Everything its state machine does runs on this queue's thread, and its serial reads
+    // on the other's
+    ros::CallbackQueue queue;
+    ros::CallbackQueue serialQueue;
+    ros::WallTimer controlTimer;
+    // Starts the end effector ahead of the arm's arrival
+    ros::WallTimer spinupTimer;
+    // Ends the dwell on time rather than on the next control tick
+    ros::WallTimer dwellTimer;
+    std::unique_ptr<ros::AsyncSpinner> spinner;
+    std::unique_ptr<ros::AsyncSpinner> serialSpinner;
+
+    // What the assignment sees of it (slotMutex)
+    ArmSlot slot;
+
+    // To keep the logs down
+    int lastIDOutOfRange;
+    int fetchWeedLogs;
+};
+std::vector<std::unique_ptr<ArmContext> > arms;
+std::mutex slotMutex;
+
+// Parameters of each arm, under arm_<index>/
+bool readArmParameters(ros::NodeHandle nodeHandle, ArmContext& arm)
+{
+    std::string prefix = "arm_" + std::to_string(arm.index) + "/";
+
+    if (!nodeHandle.getParam(prefix + "serial_output_service", arm.serialWriteName)) return false;
+    if (!nodeHandle.getParam(prefix + "serial_ack_topic", arm.serialAckTopic)) return false;
+
+    if (!nodeHandle.getParam(prefix + "rest_angle_1", arm.restAngles[0])) return false;
+    if (!nodeHandle.getParam(prefix + "rest_angle_2", arm.restAngles[1])) return false;
+    if (!nodeHandle.getParam(prefix + "rest_angle_3", arm.restAngles[2])) return false;
+
+    if (!nodeHandle.getParam(prefix + "mount_x_cm", arm.mountX)) return false;
+    if (!nodeHandle.getParam(prefix + "mount_y_cm", arm.mountY)) return false;
+
+    return true;
 }
 
-// Check for callback from motors
-bool checkSuccess(SerialUtils::CmdMsg exp_msg)
+/* Create coordinates in the Delta Arm Reference
+*   From the tracker frame, around where the arm is mounted; the rotation itself lives in deltaFrame.h
+*/
+Vector3 toDeltaFrame(const ArmContext& arm, float targetX, float targetY, float targetZ)
 {
-    urGovernor::SerialRead serialRead;   
-    SerialUtils::CmdMsg msg;
+    return delta_frame_position(targetX - arm.mountX, targetY - arm.mountY, targetZ, soilOffset);
+}
 
-    // Try to read on serial
-    if (serialReadClient.call(serialRead))
-    {
-        std::vector<char> v(serialRead.response.command.begin(), serialRead.response.command.end());
-        
-        msg.cmd_success = 0;
-        // Unpack response from read
-        SerialUtils::unpack(v, msg);
+// Same rotation for velocities (no offset)
+Vector3 toDeltaVelocity(float velX, float velY)
+{
+    return delta_frame_velocity(velX, velY);
+}
+
+// Inverse kinematics for a point in the delta frame
+//      Warm started from the last solve for the same weed if given, through the lookup table if enabled,
+//      including the full solves the warm start falls back to
+bool solveArmAngles(const ArmContext& arm, const Vector3& target, float angles[NUM_AXIES],
+                    DeltaIncrementalState* warmStart = NULL)
+{
+    if (warmStart && incrementalIkTolerance > 0)
+        return ikLutEnable ? arm.ikTable.solveIncremental(target, *warmStart, angles, incrementalIkTolerance)
+                           : arm.kinematics->solveIncremental(target, *warmStart, angles, incrementalIkTolerance);
 
-        // Check if we are done
-        if (msg == exp_msg && msg.cmd_success)
+    return ikLutEnable ? arm.ikTable.solve(target, angles)
+                       : arm.kinematics->solve(target, angles);
+}
+
+/* Joint-rate feed-forward
+ *      The Teensy only takes position targets, so the joint rates from the Jacobian
+ *      are used to lead the command: it is placed where the weed will be once it has
+ *      drifted min_update_angle.  The weed then moves through the commanded pose
+ *      instead of away from it, so each command stays good for twice as long.
+ */
+void leadArmAngles(const ArmContext& arm, const Vector3& target, const float angles[NUM_AXIES], float led[NUM_AXIES])
+{
+    float rates[NUM_AXIES];
+    float maxRate = 0;
+
+    for (int i = 0; i < NUM_AXIES; ++i)
+        led[i] = angles[i];
+
+    if (!arm.kinematics->jointVelocity(target, angles, toDeltaVelocity(0, curYVel), rates))
+        return;
+
+    for (int i = 0; i < NUM_AXIES; ++i)
+        maxRate = std::max(maxRate, (float)fabs(rates[i]));
+    if (maxRate <= 0)
+        return;
+
+    float lead = std::min(minUpdateAngle / maxRate, feedForwardMaxLead);
+    for (int i = 0; i < NUM_AXIES; ++i)
+        led[i] += rates[i] * lead;
+}
+
+// Box in the delta frame covering the cartesian limits, for the precomputed tables
+void workspaceBox(Vector3& boxMin, Vector3& boxMax)
+{
+    const float xs[] = {cartesianLimitXMin, cartesianLimitXMax};
+    const float ys[] = {cartesianLimitYMin, cartesianLimitYMax};
+
+    // The limits are in the tracker frame (around the mount); cover their bounding box in the delta frame
+    boxMin = delta_frame_position(xs[0], ys[0], 0, soilOffset);
+    boxMax = boxMin;
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 0; j < 2; ++j)
         {
-            return true;
+            Vector3 p = delta_frame_position(xs[i], ys[j], 0, soilOffset);
+            boxMin.x = std::min(boxMin.x, p.x);
+            boxMin.y = std::min(boxMin.y, p.y);
+            boxMax.x = std::max(boxMax.x, p.x);
+            boxMax.y = std::max(boxMax.y, p.y);
         }
     }
+    boxMax.z = boxMin.z + workspaceHeight;
+}
 
-    return false;
+// Build (or map from disk) the IK table covering the cartesian limits
+//      Every arm is the same build, so they all map the same file
+bool setupLookupTable(ArmContext& arm)
+{
+    Vector3 boxMin, boxMax;
+    workspaceBox(boxMin, boxMax);
+
+    ros::WallTime start = ros::WallTime::now();
+    if (!arm.ikTable.loadOrBuild(*arm.kinematics, boxMin, boxMax, ikLutResolution, ikLutMaxError, ikLutPath))
+        return false;
+
+    ROS_INFO("Arm %d IK lookup table %s in %.2fs (%d cells, %d solved exactly)", arm.index,
+        arm.ikTable.mapped() ? "mapped" : "built",
+        (ros::WallTime::now() - start).toSec(),
+        arm.ikTable.cells(), arm.ikTable.exactCells());
+    return true;
 }
 
-// Wait for success
-bool waitSuccess(SerialUtils::CmdMsg exp_msg)
+// Build the reachability map covering the cartesian limits
+bool setupReachability(ArmContext& arm)
 {
-    urGovernor::SerialRead serialRead;
-    SerialUtils::CmdMsg msg;
+    Vector3 boxMin, boxMax;
+    workspaceBox(boxMin, boxMax);
 
-    ros::Rate loopRate( 1.0 / (serialTimeoutMs / 1000.0));
-    ros::WallTime start_time = ros::WallTime::now();
-    double timeout = commandTimeoutSec;
-    while (ros::ok() && (ros::WallTime::now()- start_time).toSec() < timeout)
-    {
-        // Wait for arm done
-        // This is done by calling the serial READ client
-        // This should block until we get a CmdMsg FROM the serial line
-        if (checkSuccess(exp_msg)) {
-            ROS_DEBUG("Teensy callback received.");
-            return true;
-        }
+    // Negative angles get clamped to 0 when sent rather than turned away (see trackWeed()), so
+    // the margin is only to the upper limit
+    return arm.reachMap.build(*arm.kinematics, boxMin, boxMax, reachabilityResolution,
+                              -std::numeric_limits<float>::max(), angleLimit);
+}
+
+// Is this point (tracker frame) inside the arm's cartesian limits
+bool inArmLimits(const ArmContext& arm, float x, float y)
+{
+    x -= arm.mountX;
+    y -= arm.mountY;
+    return x <= cartesianLimitXMax && x >= cartesianLimitXMin &&
+           y <= cartesianLimitYMax && y >= cartesianLimitYMin;
+}
+
+// Past here (tracker frame) weeds have left every arm's workspace for good
+float workspaceExitY()
+{
+    float exitY = cartesianLimitYMin + arms[0]->mountY;
+    for (size_t i = 1; i < arms.size(); ++i)
+        exitY = std::min(exitY, cartesianLimitYMin + arms[i]->mountY);
+    return exitY;
+}
+
+// Can the arm reach this weed (tracker frame) now, with margin to the joint limits
+bool weedReachable(const ArmContext& arm, float x, float y, float z)
+{
+    return inArmLimits(arm, x, y) &&
+           arm.reachMap.reachable(toDeltaFrame(arm, x, y, z), reachabilityMinMargin);
+}
 
-        if (serialReadClient.call(serialRead))
+// Will the weed (tracker frame) become reachable by any arm before it leaves the workspace
+//      Weeds only move towards cartesian_limit_y_min, so walk its path there
+bool weedEverReachable(float x, float y, float z)
+{
+    float step = std::max(reachabilityResolution, 0.5f);
+    for (size_t i = 0; i < arms.size(); ++i)
+    {
+        const ArmContext& arm = *arms[i];
+        for (float py = std::min(y, cartesianLimitYMax + arm.mountY); py >= cartesianLimitYMin + arm.mountY; py -= step)
         {
-            std::vector<char> v(serialRead.response.command.begin(), serialRead.response.command.end());
-            
-            msg.cmd_success = 0;
-            // Unpack response from read
-            SerialUtils::unpack(v, msg);
-
-            // This should indicate that we are done
-            if (msg == exp_msg && msg.cmd_success)
-            {
-                ROS_DEBUG("Teensy callback received.");
+            if (weedReachable(arm, x, py, z))
                 return true;
-            }
         }
-        else
+    }
+    return false;
+}
+
+// Reachability for the tracker, so it can drop weeds before offering them to us
+//      Reachable by any of the arms, with the best margin of them
+bool checkReachable(urGovernor::CheckReachable::Request &req, urGovernor::CheckReachable::Response &res)
+{
+    res.reachable.resize(req.points.size());
+    res.margin_deg.resize(req.points.size());
+    for (size_t i = 0; i < req.points.size(); ++i)
+    {
+        const geometry_msgs::Point& p = req.points[i];
+        res.reachable[i] = false;
+        for (size_t a = 0; a < arms.size(); ++a)
         {
-            ROS_DEBUG("No response from Teensy ... retrying ...");
+            float margin = arms[a]->reachMap.margin(toDeltaFrame(*arms[a], p.x, p.y, p.z));
+            res.margin_deg[i] = a == 0 ? margin : std::max((float)res.margin_deg[i], margin);
+            res.reachable[i] = res.reachable[i] || weedReachable(*arms[a], p.x, p.y, p.z);
         }
-        loopRate.sleep();
     }
+    return true;
+}
 
-    ROS_ERROR("Timed out waiting for response from Teensy");
-    return false;
+// Write a packed CmdMsg to the arm's serial link, the serial node says what number it went out as
+bool writeCmd(ArmContext& arm, const std::string& command, uint8_t& sequence)
+{
+    urGovernor::SerialWrite serialWrite;
+    serialWrite.request.command = command;
+
+    // Send angles to HAL (via calling the serial WRITE client)
+    if (!arm.serialWriteClient.call(serialWrite) || serialWrite.response.status != 0)
+        return false;
+    sequence = serialWrite.response.sequence;
+    return true;
+}
+
+// Runs a function on the thread serving a callback queue
+class QueuedEvent : public ros::CallbackInterface
+{
+public:
+    explicit QueuedEvent(const std::function<void()>& fn) : fn_(fn) {}
+    virtual CallResult call() { fn_(); return Success; }
+
+private:
+    std::function<void()> fn_;
+};
+
+// Hand an event to the arm's worker thread
+void postControl(ArmContext& arm, const std::function<void()>& fn)
+{
+    arm.queue.addCallback(ros::CallbackInterfacePtr(new QueuedEvent(fn)));
+}
+
+void advanceArm(ArmContext& arm);
+
+// Serial thread: an ack from the arm's Teensy, pushed by its serial node as it came in
+void onSerialAck(ArmContext& arm, const urGovernor::CmdAck::ConstPtr& ackMsg)
+{
+    SerialUtils::CmdMsg msg;
+
+    std::vector<char> v(ackMsg->command.begin(), ackMsg->command.end());
+    msg.cmd_success = 0;
+    // Unpack response from read
+    SerialUtils::unpack(v, msg);
+
+    {
+        std::lock_guard<std::mutex> lock(arm.ackMutex);
+        arm.commands->ack(ackMsg->sequence, msg.cmd_type, msg.cmd_success, ros::WallTime::now().toSec());
+    }
+    arm.ackReceived.notify_all();
+
+    // The state machine may be waiting on it
+    postControl(arm, std::bind(advanceArm, std::ref(arm)));
+}
+
+/* Resend the commands in the window that are overdue or were nacked (see CommandWindow)
+ *      Runs on whichever thread sends the arm's commands (its worker, or main at startup).
+ */
+void serviceCommands(ArmContext& arm, const ros::WallTime& now)
+{
+    std::vector<CommandResend> resend;
+    std::vector<unsigned> failed;
+    {
+        std::lock_guard<std::mutex> lock(arm.ackMutex);
+        arm.commands->due(now.toSec(), resend, failed);
+    }
+    for (size_t i = 0; i < failed.size(); ++i)
+        ROS_ERROR("Arm %d command %u not acked after %d retries", arm.index, failed[i], commandRetries);
+
+    for (size_t i = 0; i < resend.size(); ++i)
+    {
+        ROS_WARN("Arm %d command %u %s, resending", arm.index, resend[i].id,
+            resend[i].nacked ? "failed on the Teensy" : "timed out");
+
+        uint8_t sequence;
+        bool written = writeCmd(arm, resend[i].bytes, sequence);
+
+        std::lock_guard<std::mutex> lock(arm.ackMutex);
+        arm.commands->resent(resend[i].id, written, sequence, ros::WallTime::now().toSec());
+    }
+}
+
+// Where a command sent with sendCmd() is at
+CommandStatus commandStatus(ArmContext& arm, unsigned id)
+{
+    std::lock_guard<std::mutex> lock(arm.ackMutex);
+    return arm.commands->status(id);
+}
+
+// Wait for an ack or a resend to be due, whichever is first
+void waitCommands(ArmContext& arm)
+{
+    std::unique_lock<std::mutex> lock(arm.ackMutex);
+    double now = ros::WallTime::now().toSec();
+    double wait = arm.commands->nextDue(now) - now;
+    if (wait <= 0)
+        return;
+    arm.ackReceived.wait_for(lock, std::chrono::duration<double>(std::max(wait, 0.001)));
+}
+
+/* Send CmdMsg over the arm's serial link, without waiting for it to be acked
+ *      expectS: how long the Teensy takes to do it (the ack is due after)
+ *      Returns the command's id for checkSuccess()/waitSuccess(), 0 if it could not be sent.
+ *  Waits only when the window is full of commands still wanted, for one to be acked or given up on.
+ */
+unsigned sendCmd(ArmContext& arm, const SerialUtils::CmdMsg& msg, double expectS = 0)
+{
+    while (ros::ok())
+    {
+        {
+            std::lock_guard<std::mutex> lock(arm.ackMutex);
+            if (arm.commands->makeRoom())
+                break;
+        }
+        ROS_DEBUG_THROTTLE(1.0, "Arm %d has %d commands in flight, waiting", arm.index, commandWindow);
+        waitCommands(arm);
+        serviceCommands(arm, ros::WallTime::now());
+    }
+
+    // Pack message
+    std::vector<char> buff;
+    SerialUtils::pack(buff, msg);
+    std::string command(buff.begin(), buff.end());
+
+    uint8_t sequence;
+    if (!writeCmd(arm, command, sequence))
+        return 0;
+
+    // Only the latest motor target matters
+    std::lock_guard<std::mutex> lock(arm.ackMutex);
+    return arm.commands->add(sequence, msg.cmd_type, command, msg.cmd_type == SerialUtils::CMDTYPE_MTRS,
+        ros::WallTime::now().toSec(), expectS);
+}
+
+// Has the command been acked, returns immediately
+bool checkSuccess(ArmContext& arm, unsigned id)
+{
+    return commandStatus(arm, id) == CMD_ACKED;
+}
+
+// Wait for the command to be acked, resending it if need be
+bool waitSuccess(ArmContext& arm, unsigned id)
+{
+    CommandStatus status;
+    while (ros::ok() && (status = commandStatus(arm, id)) == CMD_PENDING)
+    {
+        waitCommands(arm);
+        serviceCommands(arm, ros::WallTime::now());
+    }
+
+    if (status != CMD_ACKED)
+    {
+        ROS_ERROR("Arm %d command %u %s", arm.index, id, command_status_name(status));
+        return false;
+    }
+    ROS_DEBUG("Teensy callback received.");
+    return ros::ok();
 }
 
 // Configure speed and acceleration in degrees/second -- value of 0 is discarded
-bool configMotors(int speedDegS, int accelDegSS)
+//      Returns the command for waitSuccess(), 0 if it could not be sent
+unsigned configMotors(ArmContext& arm, int speedDegS, int accelDegSS)
 {
     SerialUtils::CmdMsg msg = { .cmd_type = SerialUtils::CMDTYPE_CONFIG };
     msg.mtr_speed_deg_s = speedDegS;
     msg.mtr_accel_deg_s_s = accelDegSS;
-    sendCmd(msg);
-    if(!waitSuccess(msg)) {
-        ROS_ERROR("Unable to configure motors");
-        return false;
+    return sendCmd(arm, msg);
+}
+
+// Where the last move has got to by now
+void currentArmAngles(const ArmContext& arm, const ros::WallTime& now, float angles[NUM_AXIES])
+{
+    if (!arm.armMotion.sample((now - arm.armMotionStart).toSec(), angles))
+        std::copy(arm.armTarget, arm.armTarget + NUM_AXIES, angles);
+}
+
+// Seconds a move from where the arm is now to these angles would take, without sending it
+double estimateTravel(const ArmContext& arm, const float to[NUM_AXIES])
+{
+    float from[NUM_AXIES];
+    currentArmAngles(arm, ros::WallTime::now(), from);
+
+    DeltaJointLimits limits = {(float)motorSpeedDegS, (float)motorAccelDegSS, motorJerkDegSSS};
+    DeltaTrajectory move;
+    if (relativeAngleFlag || !move.joint(from, to, limits))
+        return actuationTimeOverride;
+    return move.duration();
+}
+
+// Time the move to these angles the way the motors will run it, from wherever the last
+// move has got to by now
+//      Returns the seconds until the arm gets there
+double planArmMotion(ArmContext& arm, int angle1Deg, int angle2Deg, int angle3Deg)
+{
+    ros::WallTime now = ros::WallTime::now();
+    float from[NUM_AXIES];
+    currentArmAngles(arm, now, from);
+
+    float to[NUM_AXIES] = {(float)angle1Deg, (float)angle2Deg, (float)angle3Deg};
+    if (relativeAngleFlag)
+    {
+        for (int i = 0; i < NUM_AXIES; ++i)
+            to[i] += from[i];
     }
-    return true;
+
+    std::copy(to, to + NUM_AXIES, arm.armTarget);
+    arm.armMotionStart = now;
+
+    DeltaJointLimits limits = {(float)motorSpeedDegS, (float)motorAccelDegSS, motorJerkDegSSS};
+    if (!arm.armMotion.joint(from, to, limits))
+    {
+        // No limits to time it with, so fall back on the override
+        return actuationTimeOverride;
+    }
+    return arm.armMotion.duration();
 }
 
 // Single set point, updates only, returns immediately
-bool sendArmAngles(int angle1Deg, int angle2Deg, int angle3Deg, SerialUtils::CmdMsg* p_msg = NULL)
+//      p_cmd: the command, for checkSuccess()
+//      p_travelTime: seconds until the arm gets there
+bool sendArmAngles(ArmContext& arm, int angle1Deg, int angle2Deg, int angle3Deg, unsigned* p_cmd = NULL,
+                   double* p_travelTime = NULL)
 {
     if (angle1Deg == 10)
         angle1Deg = 11;
@@ -217,24 +788,30 @@ bool sendArmAngles(int angle1Deg, int angle2Deg, int angle3Deg, SerialUtils::Cmd
     if (angle3Deg == 10)
         angle3Deg = 11;
 
-    if (angle1Deg < restAngle1 &&
-        angle2Deg < restAngle2 &&
-        angle3Deg < restAngle3)
-        armDown = false;
+    if (angle1Deg < arm.restAngles[0] &&
+        angle2Deg < arm.restAngles[1] &&
+        angle3Deg < arm.restAngles[2])
+        arm.armDown = false;
     else
-        armDown = true;
+        arm.armDown = true;
+    arm.hovering = false;
 
-    urGovernor::SerialWrite serialWrite;
     // Pack message
     SerialUtils::CmdMsg msg = {
         .cmd_type = SerialUtils::CMDTYPE_MTRS,
         .is_relative = relativeAngleFlag,
         .mtr_angles = {(uint32_t)angle1Deg, (uint32_t)angle2Deg, (uint32_t)angle3Deg},
     };
+    // Timed first, the ack comes once the arm is there
+    double travelTime = planArmMotion(arm, angle1Deg, angle2Deg, angle3Deg);
     // Send angles to HAL (via calling the serial WRITE client)
-    if (sendCmd(msg))
+    unsigned cmd = sendCmd(arm, msg, travelTime);
+    if (cmd)
     {
-        *p_msg = msg;
+        if (p_cmd)
+            *p_cmd = cmd;
+        if (p_travelTime)
+            *p_travelTime = travelTime;
         return true;
     }
     else
@@ -244,268 +821,1204 @@ bool sendArmAngles(int angle1Deg, int angle2Deg, int angle3Deg, SerialUtils::Cmd
     }
 }
 
-// Single set point, blocks until it has been reached
-bool actuateArmAngles(int angle1Deg, int angle2Deg, int angle3Deg, bool calibrate=false)
+// Calibrate the motors, which leaves the arm at these angles
+//      Returns the command for waitSuccess(), 0 if it could not be sent
+unsigned calibrateArm(ArmContext& arm, int angle1Deg, int angle2Deg, int angle3Deg)
 {
-    bool sent = false;
-    SerialUtils::CmdMsg msg;
-    if (calibrate) {
-        msg.cmd_type = SerialUtils::CMDTYPE_CAL;
-        sent = sendCmd(msg);
-    } else {
-        sent = sendArmAngles(angle1Deg, angle2Deg, angle3Deg, &msg);
-    }
-    
-    if (sent)
-    {
-        return waitSuccess(msg);
-    }
+    SerialUtils::CmdMsg msg = { .cmd_type = SerialUtils::CMDTYPE_CAL };
+    arm.armMotion.clear();
+    arm.armTarget[0] = angle1Deg;
+    arm.armTarget[1] = angle2Deg;
+    arm.armTarget[2] = angle3Deg;
+    // Homing takes a while
+    return sendCmd(arm, msg, commandTimeoutSec);
 }
 
 
+/* End effector commands don't wait for the Teensy
+ *      The spin-up goes out ahead of the arm's arrival and the shut-down alongside the
+ *      retract move, so neither holds up the arm.  Their acks are tracked separately from
+ *      the moves' (checkEndEffector()).
+ */
+void sendEndEffector(ArmContext& arm, const SerialUtils::CmdMsg& msg)
+{
+    EndEffectorCommand& cmd = arm.endEffectorCmd;
+    if (cmd.pending)
+        ROS_DEBUG("End effector %d command sent before the last one was acked.", arm.index);
+
+    cmd.msg = msg;
+    cmd.sent = ros::WallTime::now();
+    cmd.id = sendCmd(arm, msg);
+    cmd.pending = cmd.id != 0;
+    if (!cmd.pending)
+        ROS_ERROR("Serial write to end effector %d was NOT successful.", arm.index);
+}
+
 // Starts the end effector actuation
-bool startEndEffector()
+void startEndEffector(ArmContext& arm)
 {
-    if (endEffectorRunning)
-        return true;
+    if (arm.endEffectorRunning)
+        return;
         
-    ROS_INFO("START end effector.");
-    endEffectorRunning = true;
+    ROS_INFO("START end effector %d.", arm.index);
+    arm.endEffectorRunning = true;
     SerialUtils::CmdMsg msg = { .cmd_type = SerialUtils::CMDTYPE_ENDEFF_ON };
-    sendCmd(msg);
-    if (!waitSuccess(msg)) {
-        ROS_ERROR("Unable to start end effector.");
-        return false;
-    }
-    
-    return true;
+    sendEndEffector(arm, msg);
 }
 
 // Stops the end effector actuation 
-bool stopEndEffector()
+void stopEndEffector(ArmContext& arm)
 {
-    if (!endEffectorRunning)
-        return true;
+    if (!arm.endEffectorRunning)
+        return;
     
-    ROS_INFO("STOP end effector.");
-    endEffectorRunning = false;
+    ROS_INFO("STOP end effector %d.", arm.index);
+    arm.endEffectorRunning = false;
     SerialUtils::CmdMsg msg = { .cmd_type = SerialUtils::CMDTYPE_ENDEFF_OFF };
-    sendCmd(msg);
-    if (!waitSuccess(msg)) {
-        ROS_ERROR("Unable to stop end effector.");
-        return false;
+    sendEndEffector(arm, msg);
+}
+
+// Has the Teensy acked the last end effector command, returns immediately
+void checkEndEffector(ArmContext& arm, const ros::WallTime& now)
+{
+    EndEffectorCommand& cmd = arm.endEffectorCmd;
+    if (!cmd.pending)
+        return;
+
+    CommandStatus status = commandStatus(arm, cmd.id);
+    if (status == CMD_ACKED)
+    {
+        cmd.pending = false;
+        ROS_DEBUG("End effector %d acked after %.3fs", arm.index, (now - cmd.sent).toSec());
     }
-    
-    return true;
+    else if (status != CMD_PENDING)
+    {
+        cmd.pending = false;
+        ROS_ERROR("Unable to %s end effector %d, %s.",
+            cmd.msg.cmd_type == SerialUtils::CMDTYPE_ENDEFF_ON ? "start" : "stop", arm.index,
+            command_status_name(status));
+    }
+}
+
+// Wait for the last end effector command to be acked (startup only)
+bool waitEndEffector(ArmContext& arm)
+{
+    EndEffectorCommand& cmd = arm.endEffectorCmd;
+    if (!cmd.pending)
+        return true;
+
+    cmd.pending = false;
+    return waitSuccess(arm, cmd.id);
 }
 
-/* This function performs the function of 'uprooting' a weed
- *      This function polls the tracker to update the location of the weed
+/* Spin-up timed off the predicted arrival
+ *      Each move re-times it, so the end effector comes on endEffectorSpinupS before the
+ *      arm gets there rather than a control tick after.
  */
-void doConstantTrackingUproot(urGovernor::FetchWeed &fetchWeedSrv)
+void scheduleSpinup(ArmContext& arm)
 {
-    // Continually update these angles
-    int oldAngle1 = 0,oldAngle2 = 0,oldAngle3 = 0;
-    // Save the current tracking ID
-    int currentTrackingID = fetchWeedSrv.response.tracking_id;
-    // Now we only want to query for this one
-    fetchWeedSrv.request.request_id = currentTrackingID;
+    double delay = arm.cycle->spinupIn(ros::WallTime::now().toSec());
+    arm.spinupTimer.stop();
+    if (delay <= 0)
+    {
+        startEndEffector(arm);
+        return;
+    }
+    arm.spinupTimer.setPeriod(ros::WallDuration(delay));
+    arm.spinupTimer.start();
+}
+
+// Timer for scheduleSpinup(), the arm may have moved on since
+void spinUp(ArmContext& arm, const ros::WallTimerEvent& ev)
+{
+    if (arm.cycle->working() && arm.cycle->moveSent())
+        startEndEffector(arm);
+}
 
-    static int lastIDOutOfRange = -1;
+/* Local copy of the tracker's weeds, when they are streamed (track_stream_enable)
+ *      Indexed by tracking ID, with the order the tracker offers them in, so the state
+ *      machine reads the latest position here rather than calling FetchWeed.  A weed we
+ *      have handed back is not offered again from messages stamped before we did.
+ */
+std::mutex trackMutex;
+std::unordered_map<int, urGovernor::TrackedWeed> tracks;
+std::vector<int> trackOrder;
+ros::Time tracksStamp;
+std::unordered_map<int, ros::Time> tracksHandedBack;
+
+// The tracker has been told what happened to this weed
+void trackHandedBack(int trackingID)
+{
+    std::lock_guard<std::mutex> lock(trackMutex);
+    tracksHandedBack[trackingID] = ros::Time::now();
+}
 
-    // Time this whole operation
-    ros::WallTime startActuation, startUproot;
-    double timeDelta = 0;
-    bool weedReached = false;
+// A track as FetchWeed would have answered for it
+urGovernor::FetchWeed fetchResult(int requestId, const urGovernor::TrackedWeed& track)
+{
+    urGovernor::FetchWeed fetchWeedSrv;
+    fetchWeedSrv.request.caller = 1;
+    fetchWeedSrv.request.request_id = requestId;
+    fetchWeedSrv.response.weed = track.weed;
+    fetchWeedSrv.response.tracking_id = track.tracking_id;
+    fetchWeedSrv.response.capture_stamp = track.capture_stamp;
+    return fetchWeedSrv;
+}
 
-    // Set start time
-    startActuation = ros::WallTime::now();
+// Not handed back since the tracker last published (trackMutex held)
+bool trackOffered(int trackingID)
+{
+    std::unordered_map<int, ros::Time>::const_iterator handed = tracksHandedBack.find(trackingID);
+    return handed == tracksHandedBack.end() || handed->second < tracksStamp;
+}
 
-    bool keepGoing = true;
-    // Do a continual update on the weeds location
-    ros::Rate loopRate(overallRate);
-    
-    SerialUtils::CmdMsg last_msg;
-    bool command_sent = false;
+// Same answer FetchWeed would give, out of the local tracks (trackMutex held)
+bool lookupTrack(int requestId, urGovernor::FetchWeed& fetchWeedSrv)
+{
+    fetchWeedSrv.request.caller = 1;
+    fetchWeedSrv.request.request_id = requestId;
 
-    // Main Loop for constant tracking
-    while (ros::ok() && keepGoing)
+    int trackingID = requestId;
+    // -1 is the top valid weed
+    for (size_t i = 0; trackingID == -1 && i < trackOrder.size(); ++i)
     {
-        // Get the most recent coordinates
-        if (!fetchWeedClient.call(fetchWeedSrv))
-        {
-            keepGoing = false;  
-        }
-        else
-        {
-            //// Process the current coordinates
-            float targetX = fetchWeedSrv.response.weed.point.x;
-            // Add offset here to compensate for motion
-            float targetY = fetchWeedSrv.response.weed.point.y + targetYGain*curYVel;
-            float targetZ = fetchWeedSrv.response.weed.point.z;
-            float targetSize = fetchWeedSrv.response.weed.size_cm;
-
-            // IF cartesian coordinate are out of range
-            if (targetX > cartesianLimitXMax ||
-                targetX < cartesianLimitXMin ||
-                targetY > cartesianLimitYMax ||
-                targetY < cartesianLimitYMin ) 
-            {
-                if (targetY < cartesianLimitYMin)
-                {
-                    keepGoing = false;
-                    urGovernor::RemoveWeed rmWeedSrv;
-                    rmWeedSrv.request.tracking_id = currentTrackingID;
-                    rmWeedClient.call(rmWeedSrv);
-                }
-
-                if (fetchWeedSrv.request.request_id != lastIDOutOfRange)
-                {
-                    lastIDOutOfRange = fetchWeedSrv.request.request_id;
-                    ROS_INFO("COORDS OUT OF RANGE of delta arm [(x,y,size)=(%.1f,%.1f,%.1f)]",targetX,targetY,targetSize);
-                }
-                // We are out of range!
-                keepGoing = false;
-            }
-            else
-            {
-                /* Create coordinates in the Delta Arm Reference
-                *   This conversion requires a 'rotation matrix' 
-                *   to be applied to comply with Delta library coordinates.
-                *   x' = x*cos(theta) - y*sin(theta)
-                *   y' = x*sin(theta) + y*cos(theta)
-                * Based on our setup, theta = +60 degrees AND X and Y coordinates are switched
-                */
-                float x_coord = (float)(targetY*(0.5) - (targetX)*(0.866));
-                float y_coord = (float)(targetY*(0.866) + (targetX)*(0.5));
-                float z_coord = (float)targetZ + soilOffset;    // z = 0 IS AT THE GROUND (z = is always positive)
-
-                /* Calculate angles for Delta arm */
-                robot_position(x_coord, y_coord, z_coord); 
-                
-                // Get the resulting angles from kinematics
-                int angle1Deg, angle2Deg, angle3Deg;
-                getArmAngles(&angle1Deg, &angle2Deg, &angle3Deg);
-
-                if (angle1Deg < 0)
-                    angle1Deg = 0;
-                if (angle2Deg < 0)
-                    angle2Deg = 0;
-                if (angle3Deg < 0)
-                    angle3Deg = 0;
-
-                // IF calculated angles are out of range
-                if (angle1Deg > angleLimit ||
-                    angle2Deg > angleLimit ||
-                    angle3Deg > angleLimit ||
-                    angle1Deg < 0 ||
-                    angle2Deg < 0 ||
-                    angle3Deg < 0 )
-                {
-                    ROS_INFO("ANGLES OUT OF RANGE of delta arm [(a1,a2,a3)=(%i,%i,%i)]",angle1Deg,angle2Deg,angle3Deg);
-                    keepGoing = false;
-                }
-                // ELSE if any of the angles have changed, make call to update the arm angles
-                else if(abs(angle1Deg - oldAngle1) > minUpdateAngle ||
-                        abs(angle2Deg - oldAngle2) > minUpdateAngle ||
-                        abs(angle3Deg - oldAngle3) > minUpdateAngle)
-                {
-                    // If we've already sent an arm angle and this 
-                    if(command_sent && ( 
-                        abs(angle1Deg - oldAngle1) > maxUpdateAngle ||
-                        abs(angle2Deg - oldAngle2) > maxUpdateAngle ||
-                        abs(angle3Deg - oldAngle3) > maxUpdateAngle 
-                        ))
-                    {
-                        ROS_ERROR("Angle update is too large... skipping ...");
-                    }
-                    else
-                    {
-                        oldAngle1 = angle1Deg;
-                        oldAngle2 = angle2Deg;
-                        oldAngle3 = angle3Deg;
-
-                        ROS_INFO("UPDATE weed @ (%.1f,%.1f,%.1f) [cm] -> (%i,%i,%i) [degrees]",
-                            targetX, targetY, targetZ, 
-                            angle1Deg, angle2Deg, angle3Deg);
-
-                        startEndEffector();
-
-                        // Update the arm angles
-                        if (!sendArmAngles(angle1Deg, angle2Deg, angle3Deg, &last_msg))
-                        {
-                            // This is a Fatal issue ...
-                            ROS_ERROR("Could not actuate motors to specified arm angles");
-                            ros::requestShutdown();
-
-                            keepGoing = false;
-                        } else {
-                            command_sent = true;
-                        }
-                    }
-                }
-            }
-        }
+        if (trackOffered(trackOrder[i]))
+            trackingID = trackOrder[i];
+    }
 
-        // IF weed has been reached by the arm
-        if(weedReached)
-        {
-            timeDelta = (ros::WallTime::now() - startUproot).toSec();
-            if (timeDelta >= endEffectorTime)
-            {
-                keepGoing = false;
-            }
-        }
-        // ELSE if we haven't set our flag but the motors are done their current motion
-        else if (!weedReached && command_sent && checkSuccess(last_msg))
-        {
-            weedReached = true;
-            startUproot = ros::WallTime::now();
-        }
-        // ELSE
-        else
-        {
-            timeDelta = (ros::WallTime::now() - startActuation).toSec();
-            // Override if we've hit our actuation time override
-            if (timeDelta >= actuationTimeOverride)
-            {
-                weedReached = true;
-                startUproot = ros::WallTime::now();
-            }
-        }
+    std::unordered_map<int, urGovernor::TrackedWeed>::const_iterator track = tracks.find(trackingID);
+    if (track == tracks.end())
+        return false;
 
-        // After send the arm angle update, sleep for the loop rate
-        loopRate.sleep();
-    }
+    fetchWeedSrv = fetchResult(requestId, track->second);
+    return true;
+}
 
-    // IF not weedReached
-    if (!weedReached)
+/* Hand a weed back to the tracker without working on it
+ *      remove: no arm will get to it in time, so the tracker can drop it
+ */
+void skipWeed(int trackingID, bool remove)
+{
+    if (remove)
     {
-        // Check if we should mark it as uprooted anyways
-        timeDelta = (ros::WallTime::now() - startActuation).toSec();
-        // Override if we've hit our actuation time override
-        if (timeDelta >= actuationTimeOverride)
-        {
-            weedReached = true;
-        }
+        ROS_INFO("Weed %d can't be worked on, removing it.", trackingID);
+        urGovernor::RemoveWeed rmWeedSrv;
+        rmWeedSrv.request.tracking_id = trackingID;
+        rmWeedClient.call(rmWeedSrv);
     }
 
     urGovernor::MarkUprooted markUprootedSrv;
-    // weedReached indicates the success of this call
-    markUprootedSrv.request.success = command_sent;
-    // Mark this weed as uprooted (or back to ready if not successful)
-    markUprootedSrv.request.tracking_id = currentTrackingID;
+    markUprootedSrv.request.success = false;
+    markUprootedSrv.request.tracking_id = trackingID;
     if (!markUprootedClient.call(markUprootedSrv))
     {
         ROS_INFO("Governor -- Error calling markUprooted Srv (call to tracker_node).");
     }
-
-    return;    
+    trackHandedBack(trackingID);
+}
+
+// Motion of the weeds we've been offered, by tracking ID, shared by the arms
+std::unordered_map<int, WeedPredictor> predictors;
+std::mutex predictorMutex;
+// Forget weeds not seen for this long (s)
+const double predictorExpiry = 5.0;
+
+// Since the last stats log, from every arm (statsMutex)
+std::mutex statsMutex;
+ros::WallTime statsStart;
+int statsAdmitted = 0;
+int statsRejected = 0;
+int statsMissed = 0;
+int statsUprooted = 0;
+int statsCommands = 0;
+double statsLatencySum = 0;
+double statsLatencyMax = 0;
+// Since startup, for the stats topic
+urGovernor::GovernorStats statsTotal;
+
+float pointDist(const geometry_msgs::Point& p1, const geometry_msgs::Point& p2)
+{
+    float dx = p1.x - p2.x;
+    float dy = p1.y - p2.y;
+    float dz = p1.z - p2.z;
+    float dist = sqrt( dx*dx + dy*dy + dz*dz );
+    ROS_DEBUG("Got distance: %f", dist);
+    return dist;
+}
+
+// Time until the arm is done with what it is doing now (s)
+float timeToFree(const ArmContext& arm, const ros::WallTime& now)
+{
+    return arm.cycle->timeToFree(now.toSec());
+}
+
+// Let the assignment see where the arm is at
+void updateSlot(ArmContext& arm)
+{
+    ros::WallTime now = ros::WallTime::now();
+    bool working = arm.cycle->working();
+
+    std::lock_guard<std::mutex> lock(slotMutex);
+    std::copy(arm.armTarget, arm.armTarget + NUM_AXIES, arm.slot.angles);
+    arm.slot.free = timeToFree(arm, now);
+    arm.slot.held = working ? arm.task.trackingID : -1;
+}
+
+void setArmState(ArmContext& arm, ArmState state)
+{
+    ROS_DEBUG("Governor -- arm %d %s -> %s", arm.index, arm_state_name(arm.cycle->state()), arm_state_name(state));
+    arm.cycle->enter(state, ros::WallTime::now().toSec());
+    arm.fetchRequestId = arm.cycle->working() ? arm.task.trackingID : -1;
+    arm.fetchNext = state == ARM_DWELL && prepositionEnable && !trackStreamEnable;
+    if (state == ARM_DWELL)
+    {
+        arm.dwellTimer.stop();
+        arm.dwellTimer.setPeriod(ros::WallDuration(endEffectorTime));
+        arm.dwellTimer.start();
+    }
+    updateSlot(arm);
+}
+
+WeedPredictor predictorFor(int trackingID);
+
+/* Where to hover for an upcoming weed
+ *      hover_clearance_cm above where the weed comes into the workspace, or above where it
+ *      is now if it is in already.
+ */
+Vector3 hoverPoint(const ArmContext& arm, int trackingID, const geometry_msgs::Point& weed)
+{
+    Vector3 above(weed.x, weed.y, weed.z);
+    WeedPredictor predictor = predictorFor(trackingID);
+    if (predictor.valid())
+    {
+        double now = ros::Time::now().toSec();
+        above = predictor.predict(now);
+        float entryY = cartesianLimitYMax + arm.mountY;
+        float velocityY = predictor.velocity().y;
+        if (above.y > entryY && velocityY < 0)
+            above = predictor.predict(now + (above.y - entryY) / -velocityY);
+        above.y = std::min(above.y, entryY);
+    }
+    above.z += hoverClearance;
+    return above;
+}
+
+// Where the last move leaves the tool (tracker frame)
+bool toolPosition(const ArmContext& arm, Vector3& position)
+{
+    Vector3 tool;
+    if (!arm.kinematics->forward(arm.armTarget, tool))
+        return false;
+    position = tracker_frame_position(tool, soilOffset) + Vector3(arm.mountX, arm.mountY, 0);
+    return true;
+}
+
+// Angles to send for a pose, false if the arm can't hold it
+bool commandAngles(const float solved[NUM_AXIES], int angles[NUM_AXIES])
+{
+    for (int i = 0; i < NUM_AXIES; ++i)
+    {
+        angles[i] = (int)solved[i];
+        if (angles[i] < 0 || angles[i] > angleLimit)
+            return false;
+    }
+    return true;
+}
+
+/* Pose to wait at with the tool at position (tracker frame), false if the arm can't hold it
+ *      With occlusion_enable, raised in occlusion_step_cm steps until the arm is out of the
+ *      camera's view of the detection regions.  Either way within the cartesian and angle
+ *      limits.
+ */
+bool waitAngles(const ArmContext& arm, const Vector3& position, int angles[NUM_AXIES])
+{
+    if (!inArmLimits(arm, position.x, position.y))
+        return false;
+
+    float solved[NUM_AXIES];
+    if (arm.footprint)
+    {
+        if (!arm.footprint->clearingPose(position.x, position.y, position.z, workspaceHeight, occlusionStep,
+                                         angleLimit, detectionRegions, solved))
+            return false;
+    }
+    else if (!solveArmAngles(arm, toDeltaFrame(arm, position.x, position.y, position.z), solved))
+    {
+        return false;
+    }
+    return commandAngles(solved, angles);
+}
+
+/* Send the arm back up; the move finishes in the background
+ *      hover_clearance_cm above the upcoming weed if one is given and the arm can hover
+ *      there (higher if the camera needs, with occlusion_enable).  With occlusion_enable,
+ *      otherwise raised where it is only as high as the camera needs.  Failing those to the
+ *      rest angles, which are always out of the camera's view.
+ */
+void retractArm(ArmContext& arm, int upcomingID = -1, const geometry_msgs::Point& upcoming = geometry_msgs::Point())
+{
+    ArmTask& task = arm.task;
+    arm.spinupTimer.stop();
+
+    Vector3 wait;
+    bool waiting = false;
+    if (hoverEnable && upcomingID >= 0)
+    {
+        wait = hoverPoint(arm, upcomingID, upcoming);
+        waiting = true;
+    }
+    else if (occlusionEnable && arm.armDown && toolPosition(arm, wait))
+    {
+        waiting = true;
+    }
+
+    int hover[NUM_AXIES];
+    bool hovering = waiting && waitAngles(arm, wait, hover);
+
+    // Already there
+    if (hovering && arm.hovering &&
+        fabs(hover[0] - arm.armTarget[0]) <= minUpdateAngle &&
+        fabs(hover[1] - arm.armTarget[1]) <= minUpdateAngle &&
+        fabs(hover[2] - arm.armTarget[2]) <= minUpdateAngle)
+    {
+        stopEndEffector(arm);
+        return;
+    }
+
+    if (hovering || arm.armDown)
+    {
+        const int* angles = hovering ? hover : arm.restAngles;
+        double travelTime = 0;
+        ros::WallTime sent = ros::WallTime::now();
+        if (!sendArmAngles(arm, angles[0], angles[1], angles[2], &task.lastCmd, &travelTime))
+        {
+            ROS_ERROR("Could not Reset arm positions.");
+            ros::requestShutdown();
+            return;
+        }
+        if (hovering)
+            ROS_DEBUG("Governor -- arm %d waiting at (%.1f,%.1f,%.1f) [cm] -> (%i,%i,%i) [degrees]",
+                arm.index, wait.x, wait.y, wait.z, angles[0], angles[1], angles[2]);
+        arm.hovering = hovering;
+        arm.cycle->moved((sent + ros::WallDuration(travelTime + arrivalMarginS)).toSec());
+        // Spins down on the way up
+        stopEndEffector(arm);
+        setArmState(arm, ARM_RETRACT);
+    }
+    else
+    {
+        stopEndEffector(arm);
+    }
+}
+
+/* Can the arm go straight on to this weed from where it is, without coming up first?
+ *      With occlusion_enable, only if it is out of the camera's view of the detection regions
+ *      both where it is and at the weed.  Otherwise only if the weed is within
+ *      stay_down_dist_cm of the last one.
+ */
+bool stayDown(const ArmContext& arm, const geometry_msgs::Point& weed)
+{
+    if (!occlusionEnable)
+        return pointDist(weed, arm.task.lastWeed) <= stayDownDist;
+
+    float next[NUM_AXIES];
+    if (!solveArmAngles(arm, toDeltaFrame(arm, weed.x, weed.y, weed.z), next))
+        return false;
+    return !arm.footprint->occludes(arm.armTarget, detectionRegions) &&
+           !arm.footprint->occludes(next, detectionRegions);
+}
+
+// When the position in a fetch was seen by the camera (when it got to us if the tracker doesn't say)
+double captureTime(const urGovernor::FetchWeed& fetchWeedSrv, const ros::Time& received)
+{
+    const ros::Time& stamp = fetchWeedSrv.response.capture_stamp;
+    return stamp.isZero() ? received.toSec() : stamp.toSec();
+}
+
+// Feed a fetched position (and the latest ground speed) to the weed's predictor
+//      Returns when it was seen, see expirePredictors()
+double observeWeed(const urGovernor::FetchWeed& fetchWeedSrv, const ros::Time& received)
+{
+    double captured = captureTime(fetchWeedSrv, received);
+    const geometry_msgs::Point& p = fetchWeedSrv.response.weed.point;
+
+    std::lock_guard<std::mutex> lock(predictorMutex);
+    WeedPredictor& predictor = predictors.insert(
+        std::make_pair(fetchWeedSrv.response.tracking_id, WeedPredictor(predictorNoise))).first->second;
+    predictor.updatePosition(captured, Vector3(p.x, p.y, p.z));
+    if (curYVelStamp > 0)
+        predictor.updateVelocity(curYVelStamp, curYVel);
+    return captured;
+}
+
+// Drop the predictors of weeds not seen for a while before the latest capture
+//      Once per batch of observations, it goes through all of them
+void expirePredictors(double captured)
+{
+    std::lock_guard<std::mutex> lock(predictorMutex);
+    for (std::unordered_map<int, WeedPredictor>::iterator it = predictors.begin(); it != predictors.end(); )
+    {
+        if (captured - it->second.time() > predictorExpiry)
+            it = predictors.erase(it);
+        else
+            ++it;
+    }
+}
+
+// The weed's predictor as it is now (not valid if it hasn't been seen)
+WeedPredictor predictorFor(int trackingID)
+{
+    std::lock_guard<std::mutex> lock(predictorMutex);
+    std::unordered_map<int, WeedPredictor>::const_iterator it = predictors.find(trackingID);
+    return it == predictors.end() ? WeedPredictor(predictorNoise) : it->second;
+}
+
+/* Where the weed will be when the arm gets to it (tracker frame)
+ *      The travel time depends on where we aim, so aim at where the weed is now, time
+ *      the move there, aim at where the weed will be by then, and go round again.
+ */
+Vector3 aimAtArrival(const ArmContext& arm, const WeedPredictor& predictor, double* approachTime = NULL)
+{
+    double now = ros::Time::now().toSec();
+    Vector3 aim = predictor.predict(now);
+    double approach = actuationTimeOverride;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        float angles[NUM_AXIES];
+        if (!solveArmAngles(arm, toDeltaFrame(arm, aim.x, aim.y, aim.z), angles))
+            break;
+        approach = estimateTravel(arm, angles) + arrivalMarginS;
+        aim = predictor.predict(now + approach);
+    }
+    if (approachTime)
+        *approachTime = approach;
+    return aim;
+}
+
+/* Can the weed still be finished before it leaves the arm's workspace?
+ *      Its time to exit, from the predicted Y velocity, against the approach to where it
+ *      will be on arrival plus the end effector time.  Weeds not moving towards the exit
+ *      (or not seen moving yet) are always let in.
+ */
+bool admitWeed(const ArmContext& arm, int trackingID)
+{
+    WeedPredictor predictor = predictorFor(trackingID);
+    if (!predictor.valid())
+        return true;
+
+    float velocityY = predictor.velocity().y;
+    if (velocityY >= 0)
+        return true;
+
+    double exitY = cartesianLimitYMin + arm.mountY;
+    double timeToExit = (predictor.predict(ros::Time::now().toSec()).y - exitY) / -velocityY;
+    double approachTime;
+    aimAtArrival(arm, predictor, &approachTime);
+    if (approachTime + endEffectorTime <= timeToExit)
+        return true;
+
+    ROS_INFO("Weed %d leaves arm %d in %.2fs, needs %.2fs to approach and %.2fs to uproot, skipping it.",
+        trackingID, arm.index, timeToExit, approachTime, endEffectorTime);
+    return false;
+}
+
+/* Take the weed for this arm, unless another arm already has it or one close to it
+ *      The assignment works on a snapshot of the arms, so this is what keeps two arms off
+ *      the same weed (or each other) when it is a frame behind.
+ */
+bool claimWeed(ArmContext& arm, int trackingID)
+{
+    std::vector<int> others;
+    {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        for (size_t i = 0; i < arms.size(); ++i)
+        {
+            if (arms[i].get() == &arm || arms[i]->slot.held < 0)
+                continue;
+            if (arms[i]->slot.held == trackingID)
+                return false;
+            others.push_back(arms[i]->slot.held);
+        }
+        arm.slot.held = trackingID;
+    }
+
+    double now = ros::Time::now().toSec();
+    Vector3 weed = predictorFor(trackingID).predict(now);
+    for (size_t i = 0; i < others.size(); ++i)
+    {
+        Vector3 other = predictorFor(others[i]).predict(now);
+        float dx = weed.x - other.x;
+        float dy = weed.y - other.y;
+        if (dx * dx + dy * dy < armClearance * armClearance)
+        {
+            std::lock_guard<std::mutex> lock(slotMutex);
+            arm.slot.held = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Follow the weed being worked on to its latest position
+ *      Returns false once we are done with it (out of range or not reachable)
+ */
+bool trackWeed(ArmContext& arm, const urGovernor::FetchWeed& fetchWeedSrv, const ros::Time& received)
+{
+    ArmTask& task = arm.task;
+
+    //// Process the current coordinates
+    float targetX = fetchWeedSrv.response.weed.point.x;
+    // Add offset here to compensate for motion (unless the feed-forward does it)
+    float targetY = fetchWeedSrv.response.weed.point.y + (feedForwardEnable ? 0 : targetYGain*curYVel);
+    float targetZ = fetchWeedSrv.response.weed.point.z;
+    float targetSize = fetchWeedSrv.response.weed.size_cm;
+
+    // OR where it will be when the arm gets there
+    if (predictorEnable)
+    {
+        Vector3 aim = aimAtArrival(arm, predictorFor(task.trackingID));
+        targetX = aim.x;
+        targetY = aim.y;
+        targetZ = aim.z;
+    }
+
+    // IF cartesian coordinate are out of range
+    if (!inArmLimits(arm, targetX, targetY))
+    {
+        // (for good if it is past every arm)
+        if (targetY < workspaceExitY())
+        {
+            urGovernor::RemoveWeed rmWeedSrv;
+            rmWeedSrv.request.tracking_id = task.trackingID;
+            rmWeedClient.call(rmWeedSrv);
+        }
+
+        if (task.trackingID != arm.lastIDOutOfRange)
+        {
+            arm.lastIDOutOfRange = task.trackingID;
+            ROS_INFO("COORDS OUT OF RANGE of delta arm [(x,y,size)=(%.1f,%.1f,%.1f)]",targetX,targetY,targetSize);
+        }
+        // We are out of range!
+        return false;
+    }
+
+    /* Calculate angles for Delta arm */
+    Vector3 target = toDeltaFrame(arm, targetX, targetY, targetZ);
+    float weedAngles[NUM_AXIES] = {0, 0, 0};
+    float cmdAngles[NUM_AXIES] = {0, 0, 0};
+    bool reachable = solveArmAngles(arm, target, weedAngles, &task.ikState);
+
+    if (reachable && feedForwardEnable && !predictorEnable)
+        leadArmAngles(arm, target, weedAngles, cmdAngles);
+    else
+        std::copy(weedAngles, weedAngles + NUM_AXIES, cmdAngles);
+
+    int angle1Deg = (int)cmdAngles[0];
+    int angle2Deg = (int)cmdAngles[1];
+    int angle3Deg = (int)cmdAngles[2];
+
+    // Where the weed is now, against which the last command is checked
+    int weed1Deg = (int)weedAngles[0];
+    int weed2Deg = (int)weedAngles[1];
+    int weed3Deg = (int)weedAngles[2];
+
+    if (angle1Deg < 0)
+        angle1Deg = 0;
+    if (angle2Deg < 0)
+        angle2Deg = 0;
+    if (angle3Deg < 0)
+        angle3Deg = 0;
+
+    int* oldAngle = task.oldAngles;
+
+    // IF the kinematics have no solution
+    if (!reachable)
+    {
+        ROS_INFO("COORDS NOT REACHABLE by delta arm [(x,y,z)=(%.1f,%.1f,%.1f)]",targetX,targetY,targetZ);
+        return false;
+    }
+    // ELSE IF calculated angles are out of range
+    else if (angle1Deg > angleLimit ||
+        angle2Deg > angleLimit ||
+        angle3Deg > angleLimit ||
+        angle1Deg < 0 ||
+        angle2Deg < 0 ||
+        angle3Deg < 0 )
+    {
+        ROS_INFO("ANGLES OUT OF RANGE of delta arm [(a1,a2,a3)=(%i,%i,%i)]",angle1Deg,angle2Deg,angle3Deg);
+        return false;
+    }
+    // ELSE if the weed has moved away from the last command, make call to update the arm angles
+    else if(abs(weed1Deg - oldAngle[0]) > minUpdateAngle ||
+            abs(weed2Deg - oldAngle[1]) > minUpdateAngle ||
+            abs(weed3Deg - oldAngle[2]) > minUpdateAngle)
+    {
+        // If we've already sent an arm angle and this 
+        if(arm.cycle->moveSent() && ( 
+            abs(angle1Deg - oldAngle[0]) > maxUpdateAngle ||
+            abs(angle2Deg - oldAngle[1]) > maxUpdateAngle ||
+            abs(angle3Deg - oldAngle[2]) > maxUpdateAngle 
+            ))
+        {
+            ROS_ERROR("Angle update is too large... skipping ...");
+        }
+        else
+        {
+            oldAngle[0] = angle1Deg;
+            oldAngle[1] = angle2Deg;
+            oldAngle[2] = angle3Deg;
+
+            ROS_INFO("UPDATE weed @ (%.1f,%.1f,%.1f) [cm] -> (%i,%i,%i) [degrees]",
+                targetX, targetY, targetZ, 
+                angle1Deg, angle2Deg, angle3Deg);
+
+            // Update the arm angles
+            double travelTime = 0;
+            if (!sendArmAngles(arm, angle1Deg, angle2Deg, angle3Deg, &task.lastCmd, &travelTime))
+            {
+                // This is a Fatal issue ...
+                ROS_ERROR("Could not actuate motors to specified arm angles");
+                ros::requestShutdown();
+                return false;
+            }
+
+            ros::WallTime now = ros::WallTime::now();
+            task.updatesSent++;
+            arm.cycle->moved((now + ros::WallDuration(travelTime + arrivalMarginS)).toSec());
+            scheduleSpinup(arm);
+
+            double latency = ros::Time::now().toSec() - captureTime(fetchWeedSrv, received);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            statsCommands++;
+            statsLatencySum += latency;
+            statsLatencyMax = std::max(statsLatencyMax, latency);
+        }
+    }
+    return true;
+}
+
+void startNextWeed(ArmContext& arm);
+
+// Done with the current weed, tell the tracker how it went
+void finishWeed(ArmContext& arm)
+{
+    ArmTask& task = arm.task;
+    ROS_DEBUG("Sent %d motor updates for weed %d (IK: %d exact, %d incremental)",
+        task.updatesSent, task.trackingID, task.ikState.exact_solves, task.ikState.incremental_solves);
+
+    // Let in but lost before the end effector was done with it
+    bool completed = arm.cycle->dwellDone(ros::WallTime::now().toSec());
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (completed)
+        {
+            statsUprooted++;
+            statsTotal.uprooted++;
+        }
+        else
+        {
+            statsMissed++;
+            statsTotal.missed++;
+        }
+    }
+
+    urGovernor::MarkUprooted markUprootedSrv;
+    // Having sent the arm there indicates the success of this call
+    markUprootedSrv.request.success = arm.cycle->moveSent();
+    // Mark this weed as uprooted (or back to ready if not successful)
+    markUprootedSrv.request.tracking_id = task.trackingID;
+
+    setArmState(arm, ARM_IDLE);
+    // The next move goes out before the round trip to the tracker
+    startNextWeed(arm);
+
+    if (!markUprootedClient.call(markUprootedSrv))
+    {
+        ROS_INFO("Governor -- Error calling markUprooted Srv (call to tracker_node).");
+    }
+    trackHandedBack(markUprootedSrv.request.tracking_id);
+}
+
+// Idle: take on the weed the tracker offers, if we can work on it
+void startWeed(ArmContext& arm, const urGovernor::FetchWeed& fetchWeedSrv, bool found, const ros::Time& received,
+               const DeltaIncrementalState& ikState = DeltaIncrementalState())
+{
+    ArmTask& task = arm.task;
+    const geometry_msgs::Point& weed = fetchWeedSrv.response.weed.point;
+
+    // IF there are no weeds, get out of the way
+    if (!found)
+    {
+        if (arm.armDown || arm.endEffectorRunning)
+            retractArm(arm);
+        if (arm.fetchWeedLogs % logFetchWeedInterval == 1)
+        {
+            ROS_INFO("Governor -- no weeds are current for arm %d.", arm.index);
+        }
+        arm.fetchWeedLogs++;
+        return;
+    }
+
+    // IF the arm can't get to it (yet), hand it straight back
+    //      (drop it for good if no arm ever will)
+    if (!weedReachable(arm, weed.x, weed.y, weed.z))
+    {
+        skipWeed(fetchWeedSrv.response.tracking_id, !weedEverReachable(weed.x, weed.y, weed.z));
+        return;
+    }
+
+    // IF it will be gone before we are done with it, let the tracker drop it now rather
+    //      than find out half way there (another arm may still get it in time)
+    if (admissionEnable && !admitWeed(arm, fetchWeedSrv.response.tracking_id))
+    {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            statsRejected++;
+            statsTotal.rejected++;
+        }
+        skipWeed(fetchWeedSrv.response.tracking_id, arms.size() == 1);
+        return;
+    }
+
+    // Stay down if we can, otherwise go up first and take whichever weed is on top by the
+    // time we are
+    if (((arm.armDown && !arm.hovering) || arm.endEffectorRunning) && !stayDown(arm, weed))
+    {
+        retractArm(arm, fetchWeedSrv.response.tracking_id, weed);
+        return;
+    }
+
+    // IF another arm is on it (or close to it), leave it to that one
+    if (!claimWeed(arm, fetchWeedSrv.response.tracking_id))
+    {
+        ROS_DEBUG("Governor -- weed %d is taken, arm %d leaves it.", fetchWeedSrv.response.tracking_id, arm.index);
+        return;
+    }
+
+    task.trackingID = fetchWeedSrv.response.tracking_id;
+    std::fill(task.oldAngles, task.oldAngles + NUM_AXIES, 0);
+    task.ikState = ikState;
+    task.updatesSent = 0;
+    task.lastWeed = weed;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        statsAdmitted++;
+        statsTotal.admitted++;
+    }
+    setArmState(arm, ARM_APPROACH);
+
+    // This position is as fresh as any, no need to wait for the next fetch
+    if (!trackWeed(arm, fetchWeedSrv, received))
+        finishWeed(arm);
+}
+
+/* Line up a weed to go to once the current one is done
+ *      Its IK is solved now, for where it will be when the dwell is over and the arm has got
+ *      there, so that the approach goes out the moment the arm is free.  Anything that can't
+ *      be lined up is left for startWeed() to deal with as usual.
+ */
+void prepareNextWeed(ArmContext& arm, const urGovernor::FetchWeed& fetchWeedSrv, bool found, const ros::Time& received)
+{
+    NextWeed& next = arm.next;
+    int trackingID = fetchWeedSrv.response.tracking_id;
+    if (!found || trackingID == arm.task.trackingID)
+    {
+        next.ready = false;
+        return;
+    }
+
+    const geometry_msgs::Point& weed = fetchWeedSrv.response.weed.point;
+    Vector3 aim(weed.x, weed.y, weed.z);
+    if (predictorEnable)
+    {
+        WeedPredictor predictor = predictorFor(trackingID);
+        double approachTime;
+        aimAtArrival(arm, predictor, &approachTime);
+        double dwellLeft = arm.cycle->dwellLeft(ros::WallTime::now().toSec());
+        aim = predictor.predict(ros::Time::now().toSec() + dwellLeft + approachTime);
+    }
+
+    DeltaIncrementalState ikState;
+    float angles[NUM_AXIES];
+    if (!inArmLimits(arm, aim.x, aim.y) ||
+        !solveArmAngles(arm, toDeltaFrame(arm, aim.x, aim.y, aim.z), angles, &ikState))
+    {
+        next.ready = false;
+        // The tracker gave it to us, so it goes back
+        if (!trackStreamEnable)
+            skipWeed(trackingID, false);
+        return;
+    }
+
+    if (!next.ready || next.fetch.response.tracking_id != trackingID)
+        ROS_DEBUG("Governor -- arm %d lined up weed %d after weed %d", arm.index, trackingID, arm.task.trackingID);
+    next.ready = true;
+    next.fetch = fetchWeedSrv;
+    next.received = received;
+    next.ikState = ikState;
+}
+
+/* Dwelling, with the track stream: line up the next of the weeds offered to this arm
+ *      Redone with every update, so a weed the tracker no longer offers is dropped.
+ */
+void onTracksDuringDwell(ArmContext& arm, const std::vector<urGovernor::TrackedWeed>& offered, const ros::Time& received)
+{
+    if (arm.cycle->state() != ARM_DWELL)
+        return;
+
+    std::vector<urGovernor::TrackedWeed> others;
+    for (size_t i = 0; i < offered.size(); ++i)
+    {
+        if (offered[i].tracking_id != arm.task.trackingID)
+            others.push_back(offered[i]);
+    }
+
+    int nextID = others.empty() ? -1 : others[0].tracking_id;
+    if (schedulerEnable && !others.empty())
+    {
+        // From the pose it is dwelling at
+        double now = ros::Time::now().toSec();
+        Vector3 mount(arm.mountX, arm.mountY, 0);
+        std::vector<WeedCandidate> candidates;
+        for (size_t i = 0; i < others.size(); ++i)
+        {
+            WeedPredictor predictor = predictorFor(others[i].tracking_id);
+            WeedCandidate c = {others[i].tracking_id, predictor.predict(now) - mount, predictor.velocity()};
+            candidates.push_back(c);
+        }
+        const std::vector<int>& order = arm.scheduler->plan(arm.armTarget, candidates);
+        nextID = order.empty() ? -1 : order[0];
+    }
+
+    for (size_t i = 0; i < others.size(); ++i)
+    {
+        if (others[i].tracking_id == nextID)
+        {
+            prepareNextWeed(arm, fetchResult(-1, others[i]), true, received);
+            return;
+        }
+    }
+    if (arm.next.ready)
+        ROS_DEBUG("Governor -- weed %d lined up for arm %d is gone", arm.next.fetch.response.tracking_id, arm.index);
+    arm.next.ready = false;
+}
+
+// Idle: go straight on to the weed lined up during the dwell, if it is still there
+void startNextWeed(ArmContext& arm)
+{
+    NextWeed& next = arm.next;
+    if (!next.ready || arm.cycle->state() != ARM_IDLE)
+        return;
+
+    int trackingID = next.fetch.response.tracking_id;
+    if (trackStreamEnable)
+    {
+        std::lock_guard<std::mutex> lock(trackMutex);
+        if (tracks.find(trackingID) == tracks.end() || !trackOffered(trackingID))
+        {
+            ROS_DEBUG("Governor -- weed %d lined up for arm %d is gone", trackingID, arm.index);
+            next.ready = false;
+            return;
+        }
+    }
+
+    // Going up first, it stays lined up for when the arm is
+    if (((arm.armDown && !arm.hovering) || arm.endEffectorRunning) && !stayDown(arm, next.fetch.response.weed.point))
+    {
+        retractArm(arm, trackingID, next.fetch.response.weed.point);
+        return;
+    }
+
+    next.ready = false;
+    startWeed(arm, next.fetch, true, next.received, next.ikState);
+}
+
+// Time driven transitions, on the arm's control timer and after every event
+void advanceArm(ArmContext& arm)
+{
+    ArmCycle& cycle = *arm.cycle;
+    ros::WallTime now = ros::WallTime::now();
+
+    serviceCommands(arm, now);
+    checkEndEffector(arm, now);
+
+    // Start the end effector so it is up to speed when the arm arrives (should spinUp() have missed it)
+    if (cycle.spinupIn(now.toSec()) <= 0)
+        startEndEffector(arm);
+
+    ArmState state = cycle.state();
+    ArmState due = cycle.due(now.toSec(), checkSuccess(arm, arm.task.lastCmd));
+    if (due != state)
+    {
+        // The end of the dwell is the end of the weed
+        if (state == ARM_DWELL)
+            finishWeed(arm);
+        else
+            setArmState(arm, due);
+    }
+    else if (state == ARM_IDLE)
+    {
+        startNextWeed(arm);
+    }
+    updateSlot(arm);
+}
+
+// A fetch from the tracker thread has come back
+//      (streamed tracks are fed to the predictors as they come in, see updateTracks())
+void onWeedFetched(ArmContext& arm, const urGovernor::FetchWeed& fetchWeedSrv, bool found, const ros::Time& received)
+{
+    ArmTask& task = arm.task;
+    if (found && !trackStreamEnable)
+        expirePredictors(observeWeed(fetchWeedSrv, received));
+
+    switch (arm.cycle->state())
+    {
+    case ARM_IDLE:
+        if (fetchWeedSrv.request.request_id == -1)
+            startWeed(arm, fetchWeedSrv, found, received);
+        break;
+
+    case ARM_APPROACH:
+    case ARM_DWELL:
+        // Fetches sent before we took this weed on are of no use
+        if (fetchWeedSrv.request.request_id != task.trackingID)
+            break;
+        if (!found || !trackWeed(arm, fetchWeedSrv, received))
+            finishWeed(arm);
+        break;
+
+    case ARM_RETRACT:
+        break;
+    }
+
+    advanceArm(arm);
+}
+
+/* Idle, with the track stream: take on the next of the weeds offered to this arm
+ *      With the scheduler that is the first of the best order for all of them, otherwise
+ *      the first offered (the assignment has them in order already).  Weeds in the plan
+ *      that haven't come within reach yet are waited for.  If nothing on offer can be
+ *      finished, the first weed goes through startWeed() as usual so it gets handed back.
+ */
+void onTracksOffered(ArmContext& arm, const std::vector<urGovernor::TrackedWeed>& offered, const ros::Time& received)
+{
+    if (arm.cycle->state() != ARM_IDLE)
+    {
+        advanceArm(arm);
+        return;
+    }
+
+    std::vector<int> order;
+    if (schedulerEnable)
+    {
+        // In the arm's own frame, the way the scheduler times it
+        double now = ros::Time::now().toSec();
+        Vector3 mount(arm.mountX, arm.mountY, 0);
+        std::vector<WeedCandidate> candidates;
+        for (size_t i = 0; i < offered.size(); ++i)
+        {
+            WeedPredictor predictor = predictorFor(offered[i].tracking_id);
+            WeedCandidate c = {offered[i].tracking_id, predictor.predict(now) - mount, predictor.velocity()};
+            candidates.push_back(c);
+        }
+
+        float angles[NUM_AXIES];
+        currentArmAngles(arm, ros::WallTime::now(), angles);
+        order = arm.scheduler->plan(angles, candidates);
+        ROS_DEBUG("Governor -- arm %d scheduled %d of %d weeds (%d expanded), %.2fs", arm.index,
+            (int)order.size(), (int)candidates.size(), arm.scheduler->expanded(), arm.scheduler->finish());
+    }
+    else if (!offered.empty())
+    {
+        order.push_back(offered[0].tracking_id);
+    }
+
+    for (size_t i = 0; i < offered.size(); ++i)
+    {
+        if (!order.empty() && offered[i].tracking_id != order[0])
+            continue;
+
+        const geometry_msgs::Point& weed = offered[i].weed.point;
+        if (!order.empty() && !weedReachable(arm, weed.x, weed.y, weed.z))
+            break;
+
+        startWeed(arm, fetchResult(-1, offered[i]), true, received);
+        break;
+    }
+    if (offered.empty())
+        startWeed(arm, urGovernor::FetchWeed(), false, received);
+
+    advanceArm(arm);
+}
+
+// Tracker thread: latest position of the weed being worked on (or the top valid one)
+void fetchWeed(ArmContext& arm, const ros::WallTimerEvent&)
+{
+    urGovernor::FetchWeed fetchWeedSrv;
+    fetchWeedSrv.request.caller = 1;
+    fetchWeedSrv.request.request_id = arm.fetchRequestId;
+
+    bool found = fetchWeedClient.call(fetchWeedSrv);
+    postControl(arm, std::bind(onWeedFetched, std::ref(arm), fetchWeedSrv, found, ros::Time::now()));
+
+    // And the top valid one to line up after it
+    if (arm.fetchNext.exchange(false))
+    {
+        urGovernor::FetchWeed nextWeedSrv;
+        nextWeedSrv.request.caller = 1;
+        nextWeedSrv.request.request_id = -1;
+
+        bool nextFound = fetchWeedClient.call(nextWeedSrv);
+        postControl(arm, std::bind(prepareNextWeed, std::ref(arm), nextWeedSrv, nextFound, ros::Time::now()));
+    }
+}
+
+// Tracker thread: split the offered weeds between the arms, each in the order it gets to them
+void assignTracks(const std::vector<urGovernor::TrackedWeed>& offered,
+                  std::vector<std::vector<urGovernor::TrackedWeed> >& byArm)
+{
+    std::vector<ArmSlot> slots;
+    {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        for (size_t i = 0; i < arms.size(); ++i)
+            slots.push_back(arms[i]->slot);
+    }
+
+    double now = ros::Time::now().toSec();
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].held >= 0)
+            slots[i].held_position = predictorFor(slots[i].held).predict(now);
+    }
+
+    std::vector<WeedCandidate> candidates;
+    std::unordered_map<int, size_t> offeredIndex;
+    for (size_t i = 0; i < offered.size(); ++i)
+    {
+        WeedPredictor predictor = predictorFor(offered[i].tracking_id);
+        WeedCandidate c = {offered[i].tracking_id, predictor.predict(now), predictor.velocity()};
+        candidates.push_back(c);
+        offeredIndex[offered[i].tracking_id] = i;
+    }
+    weedAssigner->assign(slots, candidates);
+
+    byArm.assign(arms.size(), std::vector<urGovernor::TrackedWeed>());
+    for (size_t a = 0; a < arms.size(); ++a)
+    {
+        const std::vector<int>& order = weedAssigner->order(a);
+        for (size_t k = 0; k < order.size(); ++k)
+            byArm[a].push_back(offered[offeredIndex[order[k]]]);
+    }
+}
+
+// Tracker thread: new tracks were published, hand each arm's state machine its weed out of them
+void updateTracks(const urGovernor::TrackedWeedArray::ConstPtr& msg)
+{
+    ros::Time received = ros::Time::now();
+    std::vector<urGovernor::FetchWeed> fetched(arms.size());
+    std::vector<bool> found(arms.size());
+    std::vector<urGovernor::TrackedWeed> offered;
+    {
+        std::lock_guard<std::mutex> lock(trackMutex);
+        tracks.clear();
+        trackOrder.clear();
+        for (size_t i = 0; i < msg->weeds.size(); ++i)
+        {
+            tracks[msg->weeds[i].tracking_id] = msg->weeds[i];
+            trackOrder.push_back(msg->weeds[i].tracking_id);
+        }
+        tracksStamp = msg->header.stamp;
+
+        // Once the tracker has published since we handed a weed back it knows, and if
+        // it still offers that weed it's fair game again
+        for (std::unordered_map<int, ros::Time>::iterator it = tracksHandedBack.begin();
+             it != tracksHandedBack.end(); )
+        {
+            if (it->second < tracksStamp)
+                it = tracksHandedBack.erase(it);
+            else
+                ++it;
+        }
+
+        for (size_t i = 0; i < arms.size(); ++i)
+            found[i] = lookupTrack(arms[i]->fetchRequestId, fetched[i]);
+        for (size_t i = 0; i < trackOrder.size(); ++i)
+        {
+            if (trackOffered(trackOrder[i]))
+                offered.push_back(tracks[trackOrder[i]]);
+        }
+    }
+
+    // Every track goes to the predictors, whichever arm ends up with it
+    double newest = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < msg->weeds.size(); ++i)
+        newest = std::max(newest, observeWeed(fetchResult(-1, msg->weeds[i]), received));
+    if (!msg->weeds.empty())
+        expirePredictors(newest);
+
+    std::vector<std::vector<urGovernor::TrackedWeed> > byArm(arms.size(), offered);
+    if (weedAssigner)
+        assignTracks(offered, byArm);
+
+    for (size_t i = 0; i < arms.size(); ++i)
+    {
+        ArmContext& arm = *arms[i];
+        if ((schedulerEnable || weedAssigner) && fetched[i].request.request_id == -1)
+            postControl(arm, std::bind(onTracksOffered, std::ref(arm), byArm[i], received));
+        else
+            postControl(arm, std::bind(onWeedFetched, std::ref(arm), fetched[i], (bool)found[i], received));
+
+        if (prepositionEnable && fetched[i].request.request_id != -1)
+            postControl(arm, std::bind(onTracksDuringDwell, std::ref(arm), byArm[i], received));
+    }
+}
+
+void controlTick(ArmContext& arm, const ros::WallTimerEvent&)
+{
+    advanceArm(arm);
+}
+
+void endDwell(ArmContext& arm, const ros::WallTimerEvent&)
+{
+    advanceArm(arm);
+}
+
+// Throughput, admission and latency, to compare runs against the simulator
+void logStats(const ros::WallTimerEvent&)
+{
+    ros::WallTime now = ros::WallTime::now();
+    double minutes = (now - statsStart).toSec() / 60.0;
+    if (minutes <= 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    double latencyMean = statsCommands ? statsLatencySum / statsCommands : 0.0;
+    ROS_INFO("Governor -- %.1f weeds/min (%d uprooted, %d missed of %d admitted, %d rejected), "
+        "detection to command %.1f ms mean, %.1f ms max",
+        statsUprooted / minutes, statsUprooted, statsMissed, statsAdmitted, statsRejected,
+        1000.0 * latencyMean, 1000.0 * statsLatencyMax);
+
+    statsTotal.header.stamp = ros::Time::now();
+    statsTotal.weeds_per_minute = statsUprooted / minutes;
+    statsTotal.latency_mean_ms = 1000.0 * latencyMean;
+    statsTotal.latency_max_ms = 1000.0 * statsLatencyMax;
+    statsPublisher.publish(statsTotal);
+
+    statsStart = now;
+    statsAdmitted = 0;
+    statsRejected = 0;
+    statsMissed = 0;
+    statsUprooted = 0;
+    statsCommands = 0;
+    statsLatencySum = 0;
+    statsLatencyMax = 0;
 }
 
 // velocity callback from tracker
 void updateVelocity(const geometry_msgs::Vector3::ConstPtr& msg){
     curYVel = msg->y;
+    curYVelStamp = ros::Time::now().toSec();
 }
 
 int main(int argc, char** argv)
@@ -514,25 +2027,60 @@ int main(int argc, char** argv)
     ros::NodeHandle nh;
     ros::NodeHandle nodeHandle("~");
 
-    int fetchWeedLogs = 0;
-
     if (!readGeneralParameters(nodeHandle))
     {
         ROS_ERROR("Could not read general parameters for urGovernor_node.");
         ros::requestShutdown();
     }
 
-    serialWriteClient = nh.serviceClient<urGovernor::SerialWrite>(serialServiceWriteName);
-    ros::service::waitForService(serialServiceWriteName);
+    // Either one leads the weed itself, so existing tuning of the gain doesn't carry over
+    if (feedForwardEnable || predictorEnable)
+    {
+        ROS_WARN("target_y_gain (%.2f) is unused with %s on", targetYGain,
+            predictorEnable ? "predictor_enable" : "feed_forward_enable");
+    }
 
-    serialReadClient = nh.serviceClient<urGovernor::SerialRead>(serialServiceReadName);
-    ros::service::waitForService(serialServiceReadName);
+    // Acks carry an 8-bit sequence number, so the window has to stay well inside it
+    if (commandWindow < 1 || commandWindow > 64)
+    {
+        ROS_ERROR("command_window must be 1 to 64... using 8");
+        commandWindow = 8;
+    }
 
-    // Subscribe to service from tracker
-    fetchWeedClient = nh.serviceClient<urGovernor::FetchWeed>(fetchWeedServiceName);
-    ros::service::waitForService(fetchWeedServiceName);
-    urGovernor::FetchWeed fetchWeedSrv;
-    urGovernor::FetchWeed fetchWeedSrvLast;
+    // Several arms split the weeds between them, which needs every weed streamed
+    if (armCount > 1 && !trackStreamEnable)
+    {
+        ROS_ERROR("Several arms need track_stream_enable... running arm 0 only");
+        armCount = 1;
+    }
+    for (int i = 0; i < std::max(armCount, 1); ++i)
+    {
+        arms.push_back(std::unique_ptr<ArmContext>(new ArmContext()));
+        arms.back()->index = i;
+        arms.back()->commands.reset(new CommandWindow(commandWindow, commandRetries, commandAckTimeout));
+        ArmCycleConfig cycleConfig = {endEffectorTime, endEffectorSpinupS, actuationTimeOverride};
+        arms.back()->cycle.reset(new ArmCycle(cycleConfig));
+        if (!readArmParameters(nodeHandle, *arms.back()))
+        {
+            ROS_ERROR("Could not read parameters for arm %d.", i);
+            ros::requestShutdown();
+        }
+    }
+
+    // Each arm has its own serial link
+    for (size_t i = 0; i < arms.size(); ++i)
+    {
+        ArmContext& arm = *arms[i];
+        arm.serialWriteClient = nh.serviceClient<urGovernor::SerialWrite>(arm.serialWriteName);
+        ros::service::waitForService(arm.serialWriteName);
+    }
+
+    // Subscribe to service from tracker (unless its weeds are streamed)
+    if (!trackStreamEnable)
+    {
+        fetchWeedClient = nh.serviceClient<urGovernor::FetchWeed>(fetchWeedServiceName);
+        ros::service::waitForService(fetchWeedServiceName);
+    }
 
     // Subscribe to second service from tracker
     markUprootedClient = nh.serviceClient<urGovernor::MarkUprooted>(markUprootedServiceName);
@@ -542,7 +2090,6 @@ int main(int argc, char** argv)
     ros::service::waitForService(rmWeedServiceName);
 
     // Subscribe to velocity updates from tracker
-    curYVel = 0;
     ros::Subscriber velocitySub = nodeHandle.subscribe(
                 velocityPublisherName,
                 1,
@@ -551,24 +2098,107 @@ int main(int argc, char** argv)
 
 
     /* Initializing Kinematics */
-    // Set tool offset (tool id == 0, x, y, z )
-    robot_tool_offset(0, 0, 0, -(toolOffset));
-    // Default deltarobot setup
-    deltarobot_setup();
+    // Every arm is the same build, with its own solver
+    for (size_t i = 0; i < arms.size(); ++i)
+    {
+        ArmContext& arm = *arms[i];
+        arm.kinematics.reset(new DeltaKinematics(armGeometry, Vector3(0, 0, -(toolOffset))));
 
-    stopEndEffector();
+        // Precompute IK over the workspace (or load it from the last run)
+        if (ikLutEnable && !setupLookupTable(arm))
+        {
+            ROS_ERROR("Could not build IK lookup table... continuing with exact IK");
+            ikLutEnable = false;
+        }
+
+        if (!setupReachability(arm))
+        {
+            ROS_ERROR("Could not build reachability map.");
+            ros::requestShutdown();
+        }
 
-    // CALIBRATE arms
-    if (!actuateArmAngles(restAngle1, restAngle2, restAngle3, true))
+        // The scheduler (and the assignment) needs to see every weed, so only with the stream
+        if (trackStreamEnable)
+        {
+            WeedSchedulerConfig config;
+            config.limits.velocity = motorSpeedDegS;
+            config.limits.accel = motorAccelDegSS;
+            config.limits.jerk = motorJerkDegSSS;
+            config.dwell = endEffectorTime;
+            config.soil_offset = soilOffset;
+            config.min_angle = 0;
+            config.max_angle = angleLimit;
+            config.x_min = cartesianLimitXMin;
+            config.x_max = cartesianLimitXMax;
+            config.y_min = cartesianLimitYMin;
+            config.y_max = cartesianLimitYMax;
+            config.window = schedulerWindow;
+            config.horizon = schedulerHorizon;
+            arm.scheduler.reset(new WeedScheduler(*arm.kinematics, config));
+        }
+        arm.slot.mount = Vector3(arm.mountX, arm.mountY, 0);
+
+        if (occlusionEnable)
+            arm.footprint.reset(new ArmFootprint(*arm.kinematics, arm.slot.mount, soilOffset,
+                                                 cameraPosition, armLinkRadius));
+    }
+    if (schedulerEnable && !trackStreamEnable)
     {
-        ROS_ERROR("Could not Initialize arm positions.");
-        ros::requestShutdown();
+        ROS_ERROR("The weed scheduler needs track_stream_enable... taking the tracker's order");
+        schedulerEnable = false;
+    }
+    if (arms.size() > 1)
+    {
+        std::vector<const WeedScheduler*> schedulers;
+        for (size_t i = 0; i < arms.size(); ++i)
+            schedulers.push_back(arms[i]->scheduler.get());
+        weedAssigner.reset(new WeedAssigner(schedulers, armClearance));
     }
 
-    // CONFIGURE motors
-    if (!configMotors(motorSpeedDegS, motorAccelDegSS))
+    // Reachability queries get their own thread so the tracker isn't stuck behind our main loop
+    ros::NodeHandle reachNodeHandle;
+    ros::CallbackQueue reachQueue;
+    reachNodeHandle.setCallbackQueue(&reachQueue);
+    ros::ServiceServer reachService = reachNodeHandle.advertiseService(reachabilityServiceName, checkReachable);
+    ros::AsyncSpinner reachSpinner(1, &reachQueue);
+    reachSpinner.start();
+
+    for (size_t i = 0; i < arms.size(); ++i)
     {
-        ROS_ERROR("Unable to configure motors... continuing with default speed & accel");
+        ArmContext& arm = *arms[i];
+
+        // Acks get their own thread; everything waiting on the Teensy goes through it
+        ros::NodeHandle serialNodeHandle;
+        serialNodeHandle.setCallbackQueue(&arm.serialQueue);
+        arm.ackSubscriber = serialNodeHandle.subscribe<urGovernor::CmdAck>(arm.serialAckTopic, 64,
+                    std::bind(onSerialAck, std::ref(arm), std::placeholders::_1),
+                    ros::VoidConstPtr(), ros::TransportHints().tcpNoDelay());
+        arm.serialSpinner.reset(new ros::AsyncSpinner(1, &arm.serialQueue));
+        arm.serialSpinner->start();
+
+        // Acks published before we're connected are lost
+        while (ros::ok() && arm.ackSubscriber.getNumPublishers() == 0)
+            ros::WallDuration(0.01).sleep();
+
+        // STOP the end effector, CALIBRATE arms and CONFIGURE motors, back to back: the
+        // Teensy runs them in the order they are sent
+        stopEndEffector(arm);
+        unsigned calibrated = calibrateArm(arm, arm.restAngles[0], arm.restAngles[1], arm.restAngles[2]);
+        unsigned configured = configMotors(arm, motorSpeedDegS, motorAccelDegSS);
+
+        if (!waitEndEffector(arm))
+        {
+            ROS_ERROR("Unable to stop end effector %d.", arm.index);
+        }
+        if (!waitSuccess(arm, calibrated))
+        {
+            ROS_ERROR("Could not Initialize arm %d positions.", arm.index);
+            ros::requestShutdown();
+        }
+        if (!waitSuccess(arm, configured))
+        {
+            ROS_ERROR("Unable to configure motors... continuing with default speed & accel");
+        }
     }
 
     // Sleep for startup to ensure we get our camera stream
@@ -576,58 +2206,55 @@ int main(int argc, char** argv)
 
     /* 
      * Main loop for urGovernor
+     *      Each arm's state machine runs on its own worker thread, driven by its timer and
+     *      by events from the tracker and its serial thread
      */
-    auto putArmsUp = [&] {
-        if (::armDown) {
-            if (!actuateArmAngles(restAngle1, restAngle2, restAngle3))
-            {
-                ROS_ERROR("Could not Reset arm positions.");
-                ros::requestShutdown();
-            }
-        }
-        stopEndEffector();
-    };
-
-    auto pointDist = [] (geometry_msgs::Point p1, geometry_msgs::Point p2) -> float {
-        float dx = p1.x - p2.x;
-        float dy = p1.y - p2.y;
-        float dz = p1.z - p2.z;
-        float dist = sqrt( dx*dx + dy*dy + dz*dz );
-        ROS_DEBUG("Got distance: %f", dist);
-        return dist;
-    };
-
-    ros::Rate loopRate(overallRate);
-    while (ros::ok())
+    for (size_t i = 0; i < arms.size(); ++i)
     {
-        fetchWeedSrv.request.caller = 1;
-        // Set to -1 to indicate we just want the top valid
-        fetchWeedSrv.request.request_id = -1;
-
-        // IF we do get a new weed
-        if (fetchWeedClient.call(fetchWeedSrv))
-        {
-            // stay down if the weeds are close
-            if (pointDist(fetchWeedSrv.response.weed.point,
-                        fetchWeedSrvLast.response.weed.point) > stayDownDist)
-                putArmsUp();
-
-            doConstantTrackingUproot(fetchWeedSrv);
-            fetchWeedSrvLast = fetchWeedSrv;
-        }
-        else
-        {
-            putArmsUp();
-            if (fetchWeedLogs % logFetchWeedInterval == 1)
-            {
-                ROS_INFO("Governor -- no weeds are current.");
-            }
-            fetchWeedLogs++;
-        }
+        ArmContext& arm = *arms[i];
+        ros::NodeHandle controlNodeHandle;
+        controlNodeHandle.setCallbackQueue(&arm.queue);
+        arm.controlTimer = controlNodeHandle.createWallTimer(
+                    ros::WallDuration(1.0 / overallRate),
+                    std::bind(controlTick, std::ref(arm), std::placeholders::_1));
+        arm.spinupTimer = controlNodeHandle.createWallTimer(
+                    ros::WallDuration(1.0 / overallRate),
+                    std::bind(spinUp, std::ref(arm), std::placeholders::_1), true, false);
+        arm.dwellTimer = controlNodeHandle.createWallTimer(
+                    ros::WallDuration(endEffectorTime),
+                    std::bind(endDwell, std::ref(arm), std::placeholders::_1), true, false);
+        arm.spinner.reset(new ros::AsyncSpinner(1, &arm.queue));
+        arm.spinner->start();
+    }
 
-        ros::spinOnce();
-        loopRate.sleep();
+    // Stats for all of them, alongside the velocity updates
+    statsStart = ros::WallTime::now();
+    statsPublisher = nh.advertise<urGovernor::GovernorStats>(statsTopic, 1);
+    ros::WallTimer statsTimer = nh.createWallTimer(
+                ros::WallDuration(statsLogInterval), logStats);
+
+    // Tracker fetches at the controller rate, or its stream, on their own thread
+    ros::NodeHandle trackerNodeHandle;
+    ros::CallbackQueue trackerQueue;
+    trackerNodeHandle.setCallbackQueue(&trackerQueue);
+    ros::WallTimer fetchTimer;
+    ros::Subscriber trackSub;
+    if (trackStreamEnable)
+    {
+        // Only the latest tracks are any use
+        trackSub = trackerNodeHandle.subscribe(trackStreamTopic, 1, updateTracks);
+    }
+    else
+    {
+        fetchTimer = trackerNodeHandle.createWallTimer(
+                    ros::WallDuration(1.0 / overallRate),
+                    std::bind(fetchWeed, std::ref(*arms[0]), std::placeholders::_1));
     }
+    ros::AsyncSpinner trackerSpinner(1, &trackerQueue);
+    trackerSpinner.start();
+
+    // Velocity updates
+    ros::spin();
 
     return 0;
 }
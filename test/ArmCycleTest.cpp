@@ -0,0 +1,87 @@
+#include "armCycle.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+static ArmCycleConfig config()
+{
+  ArmCycleConfig c = {2.0, 0.5, 1.0};
+  return c;
+}
+
+TEST(ArmCycle, approachDwellsOnceTheMoveArrives)
+{
+  ArmCycle cycle(config());
+  cycle.enter(ARM_APPROACH, 10);
+  EXPECT_TRUE(cycle.working());
+  EXPECT_FALSE(cycle.moveSent());
+  cycle.moved(13);
+
+  EXPECT_EQ(cycle.due(12, false), ARM_APPROACH);
+  // acked early, or not acked by the planned arrival
+  EXPECT_EQ(cycle.due(12, true), ARM_DWELL);
+  EXPECT_EQ(cycle.due(13, false), ARM_DWELL);
+}
+
+TEST(ArmCycle, approachWithNothingSentDwellsAnyway)
+{
+  ArmCycle cycle(config());
+  cycle.enter(ARM_APPROACH, 10);
+  EXPECT_EQ(cycle.due(10.5, true), ARM_APPROACH);
+  EXPECT_EQ(cycle.due(11, false), ARM_DWELL);
+}
+
+TEST(ArmCycle, dwellEndsInIdle)
+{
+  ArmCycle cycle(config());
+  cycle.enter(ARM_APPROACH, 10);
+  cycle.moved(11);
+  cycle.enter(ARM_DWELL, 11);
+
+  EXPECT_DOUBLE_EQ(cycle.dwellLeft(12), 1.0);
+  EXPECT_FALSE(cycle.dwellDone(12));
+  EXPECT_EQ(cycle.due(12, true), ARM_DWELL);
+  EXPECT_TRUE(cycle.dwellDone(13));
+  EXPECT_EQ(cycle.due(13, true), ARM_IDLE);
+  // the move to the weed went out
+  EXPECT_TRUE(cycle.moveSent());
+}
+
+TEST(ArmCycle, retractIdlesOnceUp)
+{
+  ArmCycle cycle(config());
+  cycle.moved(12);
+  cycle.enter(ARM_RETRACT, 10);
+  EXPECT_FALSE(cycle.working());
+  EXPECT_EQ(cycle.due(11, false), ARM_RETRACT);
+  EXPECT_EQ(cycle.due(11, true), ARM_IDLE);
+  EXPECT_EQ(cycle.due(12, false), ARM_IDLE);
+}
+
+TEST(ArmCycle, spinupLeadsTheArrival)
+{
+  ArmCycle cycle(config());
+  cycle.enter(ARM_APPROACH, 10);
+  EXPECT_GT(cycle.spinupIn(10), 1e6);
+  cycle.moved(13);
+  EXPECT_DOUBLE_EQ(cycle.spinupIn(10), 2.5);
+  EXPECT_LE(cycle.spinupIn(12.5), 0);
+
+  // not for a retract
+  cycle.enter(ARM_RETRACT, 14);
+  cycle.moved(15);
+  EXPECT_GT(cycle.spinupIn(14), 1e6);
+}
+
+TEST(ArmCycle, timeToFreeCountsTheDwellToCome)
+{
+  ArmCycle cycle(config());
+  EXPECT_DOUBLE_EQ(cycle.timeToFree(0), 0);
+  cycle.enter(ARM_APPROACH, 10);
+  EXPECT_DOUBLE_EQ(cycle.timeToFree(10), 2.0);
+  cycle.moved(13);
+  EXPECT_DOUBLE_EQ(cycle.timeToFree(10), 5.0);
+  cycle.enter(ARM_DWELL, 13);
+  EXPECT_DOUBLE_EQ(cycle.timeToFree(14), 1.0);
+  EXPECT_DOUBLE_EQ(cycle.timeToFree(20), 0);
+}
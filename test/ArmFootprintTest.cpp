@@ -0,0 +1,132 @@
+#include "armFootprint.h"
+#include "deltaFrame.h"
+#include "deltaRobot.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <algorithm>
+#include <vector>
+
+static const float SOIL_OFFSET = 3.0f;
+
+static GroundRect rect(float x_min, float x_max, float y_min, float y_max)
+{
+  GroundRect r = {x_min, x_max, y_min, y_max};
+  return r;
+}
+
+class Footprint : public ::testing::Test
+{
+protected:
+  Footprint() : kin(robot_geometry(), Vector3(0, 0, -9.0f)) {}
+
+  // tool at (x, y, z) in the tracker frame
+  void pose(float x, float y, float z, float angles[NUM_AXIES])
+  {
+    ASSERT_TRUE(kin.solve(delta_frame_position(x, y, z, SOIL_OFFSET), angles));
+  }
+
+  DeltaKinematics kin;
+};
+
+TEST(DeltaFrame, trackerFrameInvertsDeltaFrame)
+{
+  Vector3 p(12.5f, -7.0f, 4.0f);
+  Vector3 q = tracker_frame_position(delta_frame_position(p.x, p.y, p.z, SOIL_OFFSET), SOIL_OFFSET);
+  EXPECT_NEAR(q.x, p.x, 1e-2);
+  EXPECT_NEAR(q.y, p.y, 1e-2);
+  EXPECT_NEAR(q.z, p.z, 1e-4);
+}
+
+TEST_F(Footprint, toolShadowsTheSoilUnderIt)
+{
+  // straight above the arm
+  ArmFootprint footprint(kin, Vector3(), SOIL_OFFSET, Vector3(0, 0, 100), 1.0f);
+  float angles[NUM_AXIES];
+  pose(10, -5, 2, angles);
+
+  std::vector<GroundRect> regions(1, rect(9, 11, -6, -4));
+  EXPECT_TRUE(footprint.occludes(angles, regions));
+
+  regions[0] = rect(60, 70, 60, 70);
+  EXPECT_FALSE(footprint.occludes(angles, regions));
+}
+
+TEST_F(Footprint, mountMovesTheShadow)
+{
+  ArmFootprint footprint(kin, Vector3(40, 0, 0), SOIL_OFFSET, Vector3(40, 0, 100), 1.0f);
+  float angles[NUM_AXIES];
+  // 10cm out from its own mount
+  pose(10, 0, 2, angles);
+
+  std::vector<GroundRect> regions(1, rect(49, 51, -1, 1));
+  EXPECT_TRUE(footprint.occludes(angles, regions));
+  regions[0] = rect(9, 11, -1, 1);
+  EXPECT_FALSE(footprint.occludes(angles, regions));
+}
+
+TEST_F(Footprint, clearingPoseIsTheLowestClear)
+{
+  // camera ahead of the arm; going up pushes the tool's shadow back off the
+  // soil just ahead of it
+  ArmFootprint footprint(kin, Vector3(), SOIL_OFFSET, Vector3(0, 45, 80), 1.0f);
+  std::vector<GroundRect> regions(1, rect(-2, 2, 21, 25));
+
+  float low[NUM_AXIES];
+  pose(0, 20, 0, low);
+  ASSERT_TRUE(footprint.occludes(low, regions));
+
+  float angles[NUM_AXIES];
+  const float step = 0.5f;
+  ASSERT_TRUE(footprint.clearingPose(0, 20, 0, 30, step, 90, regions, angles));
+  EXPECT_FALSE(footprint.occludes(angles, regions));
+
+  Vector3 tool;
+  ASSERT_TRUE(kin.forward(angles, tool));
+  Vector3 at = tracker_frame_position(tool, SOIL_OFFSET);
+  EXPECT_NEAR(at.x, 0, 0.1);
+  EXPECT_NEAR(at.y, 20, 0.1);
+
+  // a step lower still hides them
+  float lower[NUM_AXIES];
+  pose(0, 20, at.z - step, lower);
+  EXPECT_TRUE(footprint.occludes(lower, regions));
+}
+
+TEST_F(Footprint, clearingPoseKeepsToTheJointLimits)
+{
+  // nothing to hide, only the limits keep the arm from staying where it is
+  ArmFootprint footprint(kin, Vector3(), SOIL_OFFSET, Vector3(0, 45, 80), 1.0f);
+  std::vector<GroundRect> regions;
+
+  float low[NUM_AXIES];
+  pose(0, 20, 0, low);
+  ASSERT_GT(*std::max_element(low, low + NUM_AXIES), 50);
+
+  float angles[NUM_AXIES];
+  ASSERT_TRUE(footprint.clearingPose(0, 20, 0, 30, 0.5f, 50, regions, angles));
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    EXPECT_GE(angles[i], 0);
+    EXPECT_LE(angles[i], 50);
+  }
+  Vector3 tool;
+  ASSERT_TRUE(kin.forward(angles, tool));
+  EXPECT_GT(tracker_frame_position(tool, SOIL_OFFSET).z, 0.4f);
+
+  // higher up two of the shoulders go below 0
+  EXPECT_FALSE(footprint.clearingPose(0, 20, 10, 30, 0.5f, 90, regions, angles));
+}
+
+TEST_F(Footprint, partsAboveTheCameraAreOutOfView)
+{
+  // camera below the shoulders, looking down at the far side of the bed
+  ArmFootprint footprint(kin, Vector3(), SOIL_OFFSET, Vector3(0, 0, 20), 1.0f);
+  float angles[NUM_AXIES];
+  pose(0, 0, 25, angles);
+
+  std::vector<GroundRect> shadows;
+  ASSERT_TRUE(footprint.project(angles, shadows));
+  EXPECT_TRUE(shadows.empty());
+}
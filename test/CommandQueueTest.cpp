@@ -0,0 +1,73 @@
+#include "commandQueue.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// a frame that is just its tag, enough to tell them apart
+static bool pushTag(CommandQueue &queue, uint8_t tag, bool latest_wins)
+{
+  return queue.push(&tag, 1, latest_wins);
+}
+
+static uint8_t popTag(CommandQueue &queue)
+{
+  QueuedFrame frame;
+  EXPECT_TRUE(queue.pop(frame));
+  EXPECT_EQ(frame.size, 1u);
+  return frame.bytes[0];
+}
+
+TEST(CommandQueue, othersKeepTheirOrder)
+{
+  CommandQueue queue(8);
+  for (uint8_t i = 0; i < 5; ++i) EXPECT_TRUE(pushTag(queue, i, false));
+
+  for (uint8_t i = 0; i < 5; ++i) EXPECT_EQ(popTag(queue), i);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.sent(), 5u);
+  EXPECT_EQ(queue.coalesced(), 0u);
+}
+
+TEST(CommandQueue, latestTargetReplacesTheWaitingOneAtTheBack)
+{
+  CommandQueue queue(8);
+  pushTag(queue, 1, false);
+  pushTag(queue, 10, true);
+  pushTag(queue, 2, false);
+  pushTag(queue, 11, true);
+  pushTag(queue, 12, true);
+  pushTag(queue, 3, false);
+
+  EXPECT_EQ(queue.size(), 4u);
+  EXPECT_EQ(popTag(queue), 1);
+  EXPECT_EQ(popTag(queue), 2);
+  EXPECT_EQ(popTag(queue), 12);
+  EXPECT_EQ(popTag(queue), 3);
+  EXPECT_EQ(queue.sent(), 4u);
+  EXPECT_EQ(queue.coalesced(), 2u);
+}
+
+TEST(CommandQueue, targetAlreadySentIsNotReplaced)
+{
+  CommandQueue queue(8);
+  pushTag(queue, 10, true);
+  EXPECT_EQ(popTag(queue), 10);
+
+  pushTag(queue, 11, true);
+  EXPECT_EQ(queue.size(), 1u);
+  EXPECT_EQ(popTag(queue), 11);
+  EXPECT_EQ(queue.coalesced(), 0u);
+}
+
+TEST(CommandQueue, fullQueueStillTakesANewerTarget)
+{
+  CommandQueue queue(2);
+  EXPECT_TRUE(pushTag(queue, 10, true));
+  EXPECT_TRUE(pushTag(queue, 1, false));
+  EXPECT_FALSE(pushTag(queue, 2, false));
+  EXPECT_TRUE(pushTag(queue, 11, true));
+  EXPECT_EQ(queue.dropped(), 1u);
+
+  EXPECT_EQ(popTag(queue), 1);
+  EXPECT_EQ(popTag(queue), 11);
+}
@@ -0,0 +1,179 @@
+#include "commandWindow.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// Command types, as far as the window cares
+static const int TARGET = 0;
+static const int CONFIG = 4;
+
+TEST(CommandWindow, eachAckResolvesItsOwn)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned first = window.add(1, CONFIG, "a", false, 0, 0);
+  unsigned second = window.add(2, CONFIG, "b", false, 0, 0);
+  EXPECT_NE(first, 0u);
+  EXPECT_NE(first, second);
+
+  EXPECT_TRUE(window.ack(2, CONFIG, true, 0.1));
+  EXPECT_EQ(window.status(first), CMD_PENDING);
+  EXPECT_EQ(window.status(second), CMD_ACKED);
+
+  // same number, other type
+  EXPECT_FALSE(window.ack(1, TARGET, true, 0.1));
+  EXPECT_EQ(window.status(first), CMD_PENDING);
+  EXPECT_TRUE(window.ack(1, CONFIG, true, 0.1));
+  EXPECT_EQ(window.status(first), CMD_ACKED);
+  EXPECT_EQ(window.size(), 0u);
+}
+
+TEST(CommandWindow, ackBeforeTheWriteReplies)
+{
+  CommandWindow window(8, 2, 0.5);
+  EXPECT_FALSE(window.ack(7, CONFIG, true, 1.0));
+  unsigned id = window.add(7, CONFIG, "a", false, 1.1, 0);
+  EXPECT_EQ(window.status(id), CMD_ACKED);
+
+  // too old to be its
+  window.ack(8, CONFIG, true, 1.0);
+  id = window.add(8, CONFIG, "b", false, 3.0, 0);
+  EXPECT_EQ(window.status(id), CMD_PENDING);
+}
+
+TEST(CommandWindow, overdueIsResentThenGivenUpOn)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned id = window.add(1, CONFIG, "cfg", false, 0, 1.0);
+  EXPECT_DOUBLE_EQ(window.nextDue(0), 0.5);
+
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+  window.due(1.4, resend, failed);
+  EXPECT_TRUE(resend.empty());
+
+  for (int retry = 0; retry < 2; ++retry) {
+    resend.clear();
+    window.due(1.6 + retry * 2, resend, failed);
+    ASSERT_EQ(resend.size(), 1u);
+    EXPECT_EQ(resend[0].id, id);
+    EXPECT_EQ(resend[0].bytes, "cfg");
+    EXPECT_FALSE(resend[0].nacked);
+    window.resent(id, true, 10 + retry, 1.6 + retry * 2);
+  }
+
+  resend.clear();
+  window.due(6, resend, failed);
+  EXPECT_TRUE(resend.empty());
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(failed[0], id);
+  EXPECT_EQ(window.status(id), CMD_TIMED_OUT);
+}
+
+TEST(CommandWindow, nackIsResentStraightAway)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned id = window.add(1, CONFIG, "cfg", false, 0, 5.0);
+  EXPECT_TRUE(window.ack(1, CONFIG, false, 0.1));
+  EXPECT_EQ(window.status(id), CMD_PENDING);
+  EXPECT_DOUBLE_EQ(window.nextDue(0.1), 0.1);
+
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+  window.due(0.1, resend, failed);
+  ASSERT_EQ(resend.size(), 1u);
+  EXPECT_TRUE(resend[0].nacked);
+
+  // answers to the number it went out as the second time
+  window.resent(id, true, 2, 0.1);
+  EXPECT_FALSE(window.ack(1, CONFIG, true, 0.2));
+  EXPECT_TRUE(window.ack(2, CONFIG, true, 0.2));
+  EXPECT_EQ(window.status(id), CMD_ACKED);
+}
+
+TEST(CommandWindow, replacedTargetIsDroppedNotResent)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned old_target = window.add(1, TARGET, "a", true, 0, 0);
+  unsigned config = window.add(2, CONFIG, "b", false, 0, 0);
+  unsigned new_target = window.add(3, TARGET, "c", true, 0, 0);
+
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+  window.due(1, resend, failed);
+  ASSERT_EQ(resend.size(), 2u);
+  EXPECT_EQ(resend[0].id, config);
+  EXPECT_EQ(resend[1].id, new_target);
+  EXPECT_TRUE(failed.empty());
+  EXPECT_EQ(window.status(old_target), CMD_REPLACED);
+}
+
+TEST(CommandWindow, fullWindowMakesRoomOnlyByDroppingReplacedTargets)
+{
+  CommandWindow window(2, 2, 0.5);
+  unsigned target = window.add(1, TARGET, "a", true, 0, 0);
+  window.add(2, CONFIG, "b", false, 0, 0);
+  EXPECT_FALSE(window.makeRoom());
+
+  window.ack(2, CONFIG, true, 0);
+  EXPECT_TRUE(window.makeRoom());
+  window.add(3, TARGET, "c", true, 0, 0);
+  EXPECT_TRUE(window.makeRoom());
+  EXPECT_EQ(window.status(target), CMD_REPLACED);
+  EXPECT_EQ(window.size(), 1u);
+}
+
+TEST(CommandWindow, longFinishedIsNotTakenAsAcked)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned first = window.add(0, CONFIG, "a", false, 0, 0);
+  window.ack(0, CONFIG, false, 0);
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+  window.due(0, resend, failed);
+  window.resent(first, false, 0, 0);
+  window.due(1, resend, failed);
+  window.resent(first, false, 0, 1);
+  window.due(2, resend, failed);
+  ASSERT_EQ(window.status(first), CMD_TIMED_OUT);
+
+  for (int i = 1; i < 100; ++i) {
+    window.add(i, CONFIG, "a", false, 0, 0);
+    window.ack(i, CONFIG, true, 0);
+  }
+
+  EXPECT_EQ(window.status(first), CMD_EXPIRED);
+  EXPECT_EQ(window.status(0), CMD_NEVER_SENT);
+  EXPECT_EQ(window.status(first + 100), CMD_NEVER_SENT);
+}
+
+TEST(CommandWindow, givenUpOnAfterNacksSaysSo)
+{
+  CommandWindow window(8, 1, 0.5);
+  unsigned id = window.add(1, CONFIG, "cfg", false, 0, 0);
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+
+  window.ack(1, CONFIG, false, 0.1);
+  window.due(0.1, resend, failed);
+  ASSERT_EQ(resend.size(), 1u);
+  window.resent(id, true, 2, 0.1);
+  window.ack(2, CONFIG, false, 0.2);
+  window.due(0.2, resend, failed);
+
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(window.status(id), CMD_NACKED);
+}
+
+TEST(CommandWindow, ackBeforeTheResendReplies)
+{
+  CommandWindow window(8, 2, 0.5);
+  unsigned id = window.add(1, CONFIG, "cfg", false, 0, 0);
+  std::vector<CommandResend> resend;
+  std::vector<unsigned> failed;
+  window.due(1, resend, failed);
+  ASSERT_EQ(resend.size(), 1u);
+
+  EXPECT_FALSE(window.ack(2, CONFIG, true, 1.1));
+  window.resent(id, true, 2, 1.2);
+  EXPECT_EQ(window.status(id), CMD_ACKED);
+}
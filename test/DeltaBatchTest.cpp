@@ -0,0 +1,67 @@
+#include "deltaRobot.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+extern DeltaRobot robot;
+
+// Same workspace the governor is configured for (delta frame, cm)
+static void randomTargets(std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, size_t n)
+{
+  x.resize(n);
+  y.resize(n);
+  z.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = -30.0f + 60.0f * (float)rand() / RAND_MAX;
+    y[i] = -30.0f + 60.0f * (float)rand() / RAND_MAX;
+    z[i] = 15.0f * (float)rand() / RAND_MAX;
+  }
+}
+
+TEST(DeltaBatch, matchesScalar)
+{
+  robot_tool_offset(0, 0, 0, -9.0f);
+  deltarobot_setup();
+
+  // not a multiple of the SIMD width so the tail gets exercised
+  const size_t n = 1003;
+  std::vector<float> x, y, z;
+  randomTargets(x, y, z, n);
+
+  std::vector<float> a1(n), a2(n), a3(n);
+  int valid = robot_position_batch(&x[0], &y[0], &z[0], &a1[0], &a2[0], &a3[0], (int)n);
+
+  int scalarValid = 0;
+  double worst = 0;
+  for (size_t i = 0; i < n; ++i) {
+    robot_position(x[i], y[i], z[i]);
+    Vector3 ang(robot.arms[0].angle, robot.arms[1].angle, robot.arms[2].angle);
+    if (isnan(ang.x) || isnan(ang.y) || isnan(ang.z)) {
+      EXPECT_TRUE(isnan(a1[i]) || isnan(a2[i]) || isnan(a3[i]));
+      continue;
+    }
+    ++scalarValid;
+    worst = std::max(worst, (double)fabs(ang.x - a1[i]));
+    worst = std::max(worst, (double)fabs(ang.y - a2[i]));
+    worst = std::max(worst, (double)fabs(ang.z - a3[i]));
+  }
+  EXPECT_EQ(scalarValid, valid);
+  // vatan2() is good to ~2e-6 rad, which comes out at ~1.1e-4 deg here
+  EXPECT_LT(worst, 5e-4);
+}
+
+TEST(DeltaBatch, unreachableIsNan)
+{
+  robot_tool_offset(0, 0, 0, -9.0f);
+  deltarobot_setup();
+
+  float x = 500, y = 0, z = 0;
+  float a1, a2, a3;
+  EXPECT_EQ(0, robot_position_batch(&x, &y, &z, &a1, &a2, &a3, 1));
+  EXPECT_TRUE(isnan(a1) || isnan(a2) || isnan(a3));
+}
@@ -0,0 +1,217 @@
+#include "deltaRobot.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+extern DeltaRobot robot;
+
+static Vector3 randomTarget()
+{
+  return Vector3(-30.0f + 60.0f * (float)rand() / RAND_MAX,
+                 -30.0f + 60.0f * (float)rand() / RAND_MAX,
+                 3.0f + 12.0f * (float)rand() / RAND_MAX);
+}
+
+TEST(DeltaKinematics, matchesGlobalRobot)
+{
+  robot_tool_offset(0, 0, 0, -9.0f);
+  deltarobot_setup();
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+
+  for (int i = 0; i < 1000; ++i) {
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES];
+    bool ok = kin.solve(p, angles);
+    robot_position(p.x, p.y, p.z);
+    if (!ok) continue;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      EXPECT_FLOAT_EQ(robot.arms[a].angle, angles[a]);
+    }
+  }
+}
+
+TEST(DeltaKinematics, forwardInvertsSolve)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+
+  for (int i = 0; i < 1000; ++i) {
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES];
+    if (!kin.solve(p, angles)) continue;
+
+    Vector3 q;
+    ASSERT_TRUE(kin.forward(angles, q));
+    EXPECT_NEAR(p.x, q.x, 1e-2);
+    EXPECT_NEAR(p.y, q.y, 1e-2);
+    EXPECT_NEAR(p.z, q.z, 1e-2);
+  }
+}
+
+TEST(DeltaKinematics, unreachable)
+{
+  DeltaKinematics kin(robot_geometry());
+  float angles[NUM_AXIES];
+  EXPECT_FALSE(kin.solve(Vector3(500, 0, 0), angles));
+}
+
+TEST(DeltaKinematics, perInstanceToolOffset)
+{
+  DeltaKinematics a(robot_geometry(), Vector3(0, 0, 0));
+  DeltaKinematics b(robot_geometry(), Vector3(0, 0, -5.0f));
+
+  float angA[NUM_AXIES], angB[NUM_AXIES];
+  ASSERT_TRUE(a.solve(Vector3(3, 4, 10), angA));
+  ASSERT_TRUE(b.solve(Vector3(3, 4, 5), angB));
+  for (int i = 0; i < NUM_AXIES; ++i) {
+    EXPECT_FLOAT_EQ(angA[i], angB[i]);
+  }
+}
+
+TEST(DeltaKinematics, concurrentSolve)
+{
+  const DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  const int n = 2000;
+  std::vector<Vector3> targets;
+  for (int i = 0; i < n; ++i) targets.push_back(randomTarget());
+
+  // reference on this thread
+  std::vector<float> expected(n * NUM_AXIES);
+  for (int i = 0; i < n; ++i) kin.solve(targets[i], &expected[i * NUM_AXIES]);
+
+  std::vector<float> got[4];
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    got[t].resize(n * NUM_AXIES);
+    workers.push_back(std::thread([&, t] {
+      for (int i = 0; i < n; ++i) kin.solve(targets[i], &got[t][i * NUM_AXIES]);
+    }));
+  }
+  for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+
+  for (int t = 0; t < 4; ++t) {
+    for (int i = 0; i < n * NUM_AXIES; ++i) {
+      if (isnan(expected[i])) continue;
+      EXPECT_EQ(expected[i], got[t][i]);
+    }
+  }
+}
+
+TEST(DeltaKinematics, inverseJacobianMatchesFiniteDifference)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  const float h = 1e-2f;
+
+  for (int i = 0; i < 200; ++i) {
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES], jinv[NUM_AXIES][3];
+    if (!kin.solve(p, angles)) continue;
+    ASSERT_TRUE(kin.inverseJacobian(p, angles, jinv));
+
+    Vector3 axes[3] = {Vector3(h, 0, 0), Vector3(0, h, 0), Vector3(0, 0, h)};
+    for (int c = 0; c < 3; ++c) {
+      float plus[NUM_AXIES], minus[NUM_AXIES];
+      ASSERT_TRUE(kin.solve(p + axes[c], plus));
+      ASSERT_TRUE(kin.solve(p - axes[c], minus));
+      for (int a = 0; a < NUM_AXIES; ++a) {
+        float numeric = (plus[a] - minus[a]) / (2 * h);
+        EXPECT_NEAR(numeric, jinv[a][c], 2e-2 + 1e-2 * fabs(numeric));
+      }
+    }
+  }
+}
+
+TEST(DeltaKinematics, jacobianInvertsInverseJacobian)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+
+  for (int i = 0; i < 200; ++i) {
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES], jinv[NUM_AXIES][3], j[3][NUM_AXIES];
+    if (!kin.solve(p, angles)) continue;
+    ASSERT_TRUE(kin.inverseJacobian(p, angles, jinv));
+    ASSERT_TRUE(kin.jacobian(angles, j));
+
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        float sum = 0;
+        for (int k = 0; k < 3; ++k) sum += j[r][k] * jinv[k][c];
+        EXPECT_NEAR(r == c ? 1.0f : 0.0f, sum, 1e-3);
+      }
+    }
+  }
+}
+
+TEST(DeltaKinematics, jointVelocityPredictsMotion)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  Vector3 p(5, -10, 6);
+  Vector3 v(0, -20.0f, 0);  // weed moving under the arm, cm/s
+  const float dt = 0.01f;
+
+  float angles[NUM_AXIES], rates[NUM_AXIES], later[NUM_AXIES];
+  ASSERT_TRUE(kin.solve(p, angles));
+  ASSERT_TRUE(kin.jointVelocity(p, angles, v, rates));
+  ASSERT_TRUE(kin.solve(p + v * dt, later));
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    EXPECT_NEAR(later[a], angles[a] + rates[a] * dt, 1e-2);
+  }
+}
+
+TEST(DeltaKinematics, incrementalWithinErrorBound)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  const float tolerance = 0.5f;   // cm
+  const float maxError = 0.05f;   // degrees, with every shoulder below 80
+  const float maxAngle = 80;
+
+  srand(5);
+  int incremental = 0;
+  for (int i = 0; i < 200; ++i) {
+    DeltaIncrementalState state;
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES], exact[NUM_AXIES];
+    if (!kin.solveIncremental(p, state, angles, tolerance)) continue;
+    if (*std::max_element(angles, angles + NUM_AXIES) > maxAngle) continue;
+
+    // weed drifting under the arm a few mm per control tick, for as long as
+    // it stays in the range the bound is given for
+    Vector3 step(0.02f, -0.3f, 0.01f);
+    for (int tick = 0; tick < 20; ++tick) {
+      p = p + step;
+      if (!kin.solve(p, exact) || *std::max_element(exact, exact + NUM_AXIES) > maxAngle) break;
+      ASSERT_TRUE(kin.solveIncremental(p, state, angles, tolerance));
+      for (int a = 0; a < NUM_AXIES; ++a) {
+        EXPECT_NEAR(exact[a], angles[a], maxError);
+      }
+    }
+    incremental += state.incremental_solves;
+  }
+  EXPECT_GT(incremental, 1000);
+}
+
+TEST(DeltaKinematics, incrementalFallsBackOnLargeStep)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaIncrementalState state;
+  float angles[NUM_AXIES], exact[NUM_AXIES];
+
+  ASSERT_TRUE(kin.solveIncremental(Vector3(0, 0, 5), state, angles, 0.5f));
+  EXPECT_EQ(1, state.exact_solves);
+
+  Vector3 far(10, -10, 5);
+  ASSERT_TRUE(kin.solveIncremental(far, state, angles, 0.5f));
+  EXPECT_EQ(2, state.exact_solves);
+  EXPECT_EQ(0, state.incremental_solves);
+  ASSERT_TRUE(kin.solve(far, exact));
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    EXPECT_FLOAT_EQ(exact[a], angles[a]);
+  }
+
+  EXPECT_FALSE(kin.solveIncremental(Vector3(500, 0, 0), state, angles, 0.5f));
+  EXPECT_FALSE(state.valid);
+}
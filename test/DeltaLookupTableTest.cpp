@@ -0,0 +1,114 @@
+#include "deltaRobot.h"
+#include "deltaLookupTable.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <stdio.h>
+#include <unistd.h>
+
+static const Vector3 boxMin(-30.0f, -30.0f, 3.0f);
+static const Vector3 boxMax(30.0f, 30.0f, 13.0f);
+
+static Vector3 randomInBox()
+{
+  return Vector3(boxMin.x + (boxMax.x - boxMin.x) * (float)rand() / RAND_MAX,
+                 boxMin.y + (boxMax.y - boxMin.y) * (float)rand() / RAND_MAX,
+                 boxMin.z + (boxMax.z - boxMin.z) * (float)rand() / RAND_MAX);
+}
+
+TEST(DeltaLookupTable, interpolationWithinBound)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaLookupTable table;
+  const float maxError = 0.1f;
+  ASSERT_TRUE(table.build(kin, boxMin, boxMax, 1.0f, maxError));
+
+  for (int i = 0; i < 20000; ++i) {
+    Vector3 p = randomInBox();
+    float exact[NUM_AXIES], approx[NUM_AXIES];
+    bool ok = kin.solve(p, exact);
+    ASSERT_EQ(ok, table.solve(p, approx));
+    if (!ok) continue;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      // the bound is checked at points in each cell, between them it can be a little over
+      EXPECT_NEAR(exact[a], approx[a], 1.1f * maxError);
+    }
+  }
+}
+
+TEST(DeltaLookupTable, outsideBoxUsesExact)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaLookupTable table;
+  ASSERT_TRUE(table.build(kin, boxMin, boxMax, 2.0f, 0.1f));
+
+  Vector3 p(0, 0, 20.0f);
+  float exact[NUM_AXIES], approx[NUM_AXIES];
+  EXPECT_FALSE(table.lookup(p, approx));
+  ASSERT_TRUE(table.solve(p, approx));
+  ASSERT_TRUE(kin.solve(p, exact));
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    EXPECT_FLOAT_EQ(exact[a], approx[a]);
+  }
+}
+
+TEST(DeltaLookupTable, saveAndMap)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  char path[] = "/tmp/urGovernorLutXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  DeltaLookupTable built;
+  ASSERT_TRUE(built.build(kin, boxMin, boxMax, 2.0f, 0.1f));
+  ASSERT_TRUE(built.save(path));
+
+  DeltaLookupTable mapped;
+  uint64_t key = DeltaLookupTable::key(kin, boxMin, boxMax, 2.0f, 0.1f);
+  ASSERT_TRUE(mapped.map(path, kin, key));
+  EXPECT_TRUE(mapped.mapped());
+  EXPECT_EQ(built.cells(), mapped.cells());
+  EXPECT_EQ(built.exactCells(), mapped.exactCells());
+
+  for (int i = 0; i < 1000; ++i) {
+    Vector3 p = randomInBox();
+    float a[NUM_AXIES], b[NUM_AXIES];
+    bool ok = built.solve(p, a);
+    ASSERT_EQ(ok, mapped.solve(p, b));
+    if (!ok) continue;
+    for (int j = 0; j < NUM_AXIES; ++j) {
+      EXPECT_EQ(a[j], b[j]);
+    }
+  }
+
+  // a different tool must not pick up this table
+  DeltaKinematics other(robot_geometry(), Vector3(0, 0, -5.0f));
+  DeltaLookupTable stale;
+  EXPECT_FALSE(stale.map(path, other, DeltaLookupTable::key(other, boxMin, boxMax, 2.0f, 0.1f)));
+
+  unlink(path);
+}
+
+TEST(DeltaLookupTable, incrementalFallsBackToTheTable)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaLookupTable table;
+  ASSERT_TRUE(table.build(kin, boxMin, boxMax, 1.0f, 0.1f));
+
+  DeltaIncrementalState state;
+  float angles[NUM_AXIES], looked[NUM_AXIES];
+  Vector3 p(3.3f, -7.6f, 8.2f);
+  ASSERT_TRUE(table.lookup(p, looked));
+  ASSERT_TRUE(table.solveIncremental(p, state, angles, 0.5f));
+  EXPECT_EQ(state.exact_solves, 1);
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    EXPECT_EQ(angles[a], looked[a]);
+  }
+
+  // a small step is a correction from there
+  ASSERT_TRUE(table.solveIncremental(p + Vector3(0.2f, 0, 0), state, angles, 0.5f));
+  EXPECT_EQ(state.incremental_solves, 1);
+}
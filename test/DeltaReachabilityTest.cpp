@@ -0,0 +1,101 @@
+#include "deltaRobot.h"
+#include "deltaReachability.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+static const Vector3 boxMin(-30.0f, -30.0f, 3.0f);
+static const Vector3 boxMax(30.0f, 30.0f, 13.0f);
+
+static float exactMargin(const DeltaKinematics& kin, const Vector3& p, float minAngle, float maxAngle)
+{
+  float angles[NUM_AXIES];
+  if (!kin.solve(p, angles)) return DeltaReachability::UNREACHABLE;
+  float m = maxAngle - minAngle;
+  for (int a = 0; a < NUM_AXIES; ++a) {
+    m = std::min(m, std::min(angles[a] - minAngle, maxAngle - angles[a]));
+  }
+  return m;
+}
+
+TEST(DeltaReachability, agreesWithExactAwayFromEdge)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaReachability map;
+  ASSERT_TRUE(map.build(kin, boxMin, boxMax, 0.5f, 0, 90));
+
+  int checked = 0;
+  for (int i = 0; i < 20000; ++i) {
+    Vector3 p(boxMin.x + (boxMax.x - boxMin.x) * (float)rand() / RAND_MAX,
+              boxMin.y + (boxMax.y - boxMin.y) * (float)rand() / RAND_MAX,
+              boxMin.z + (boxMax.z - boxMin.z) * (float)rand() / RAND_MAX);
+    float exact = exactMargin(kin, p, 0, 90);
+    float approx = map.margin(p);
+
+    // a clear answer either way has to match
+    if (exact > 2.0f) {
+      EXPECT_TRUE(map.reachable(p)) << exact << " " << approx;
+      ++checked;
+    }
+    if (exact < -2.0f) {
+      EXPECT_FALSE(map.reachable(p)) << exact << " " << approx;
+    }
+  }
+  EXPECT_GT(checked, 0);
+}
+
+TEST(DeltaReachability, outsideBox)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaReachability map;
+  ASSERT_TRUE(map.build(kin, boxMin, boxMax, 1.0f, 0, 90));
+
+  EXPECT_EQ(DeltaReachability::UNREACHABLE, map.margin(Vector3(0, 0, 40)));
+  EXPECT_FALSE(map.reachable(Vector3(100, 0, 5)));
+}
+
+TEST(DeltaReachability, batchQuery)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaReachability map;
+  ASSERT_TRUE(map.build(kin, boxMin, boxMax, 1.0f, 0, 90));
+
+  float x[] = {0, 100, 5, -10};
+  float y[] = {0, 0, 5, 10};
+  float z[] = {5, 5, 8, 40};
+  float margins[4];
+  int n = map.query(x, y, z, margins, 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FLOAT_EQ(map.margin(Vector3(x[i], y[i], z[i])), margins[i]);
+  }
+  EXPECT_EQ(n, (int)std::count_if(margins, margins + 4, [](float m) { return m >= 0; }));
+}
+
+// As the governor builds it: negative angles are clamped when sent, so only
+// the upper limit counts
+TEST(DeltaReachability, noLowerLimit)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaReachability bounded, unbounded;
+  ASSERT_TRUE(bounded.build(kin, boxMin, boxMax, 1.0f, 0, 90));
+  ASSERT_TRUE(unbounded.build(kin, boxMin, boxMax, 1.0f, -std::numeric_limits<float>::max(), 90));
+
+  int below = 0;
+  for (float z = boxMin.z; z <= boxMax.z; z += 1.0f) {
+    Vector3 p(20, 0, z);
+    float angles[NUM_AXIES];
+    if (!kin.solve(p, angles)) continue;
+    float lowest = *std::min_element(angles, angles + NUM_AXIES);
+    float highest = *std::max_element(angles, angles + NUM_AXIES);
+    if (lowest >= 0 || highest > 90) continue;
+    below++;
+    EXPECT_FALSE(bounded.reachable(p));
+    EXPECT_NEAR(unbounded.margin(p), 90 - highest, 0.5f);
+  }
+  EXPECT_GT(below, 0);
+}
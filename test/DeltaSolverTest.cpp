@@ -0,0 +1,111 @@
+#include "deltaRobot.h"
+#include "deltaSolver.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <math.h>
+#include <stdlib.h>
+
+extern DeltaRobot robot;
+
+// The other arm build, with a longer forearm
+struct LongForearmSpec {
+  static constexpr float center_to_shoulder = 7.5f;
+  static constexpr float shoulder_to_elbow = 30.0f;
+  static constexpr float elbow_to_wrist = 50.0f;
+  static constexpr float effector_to_wrist = 5.0f;
+  static constexpr float center_to_floor = 55.0f;
+};
+
+typedef DeltaSolver<DeltaStaticGeometry<UprootArmSpec> > UprootSolver;
+typedef DeltaSolver<DeltaStaticGeometry<LongForearmSpec> > LongForearmSolver;
+
+// the whole descriptor is usable at compile time
+static_assert(DeltaStaticGeometry<UprootArmSpec>::measurements().elbow_to_wrist == 45.0f,
+              "static geometry should fold");
+
+static Vector3 randomTarget()
+{
+  return Vector3(-30.0f + 60.0f * (float)rand() / RAND_MAX,
+                 -30.0f + 60.0f * (float)rand() / RAND_MAX,
+                 -5.0f + 25.0f * (float)rand() / RAND_MAX);
+}
+
+template <class Solver>
+static void expectMatchesRuntime(const Solver& fixed, const DeltaGeometry& measurements)
+{
+  DeltaSolver<DeltaRuntimeGeometry> runtime(DeltaRuntimeGeometry(measurements), Vector3(0, 0, -9.0f));
+
+  srand(3);
+  for (int i = 0; i < 2000; ++i) {
+    Vector3 p = randomTarget();
+    float a[NUM_AXIES], b[NUM_AXIES];
+    bool okA = fixed.solve(p, a);
+    bool okB = runtime.solve(p, b);
+    ASSERT_EQ(okA, okB);
+    if (!okA) continue;
+    for (int k = 0; k < NUM_AXIES; ++k) {
+      EXPECT_NEAR(a[k], b[k], 1e-3);
+    }
+  }
+}
+
+TEST(DeltaSolver, staticMatchesRuntime)
+{
+  UprootSolver fixed(DeltaStaticGeometry<UprootArmSpec>(), Vector3(0, 0, -9.0f));
+  expectMatchesRuntime(fixed, DeltaStaticGeometry<UprootArmSpec>::measurements());
+}
+
+TEST(DeltaSolver, otherBuildMatchesRuntime)
+{
+  LongForearmSolver fixed(DeltaStaticGeometry<LongForearmSpec>(), Vector3(0, 0, -9.0f));
+  expectMatchesRuntime(fixed, DeltaStaticGeometry<LongForearmSpec>::measurements());
+
+  // and is actually a different arm
+  UprootSolver uproot(DeltaStaticGeometry<UprootArmSpec>(), Vector3(0, 0, -9.0f));
+  float a[NUM_AXIES], b[NUM_AXIES];
+  ASSERT_TRUE(fixed.solve(Vector3(0, 0, 6), a));
+  ASSERT_TRUE(uproot.solve(Vector3(0, 0, 6), b));
+  EXPECT_GT(fabs(a[0] - b[0]), 1.0f);
+}
+
+TEST(DeltaSolver, matchesV8Stages)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+
+  srand(4);
+  for (int i = 0; i < 2000; ++i) {
+    Vector3 p = randomTarget();
+    float angles[NUM_AXIES];
+    if (!kin.solve(p, angles)) continue;
+
+    Vector3 ee = p - kin.toolOffset();
+    for (int k = 0; k < NUM_AXIES; ++k) {
+      float stages = kin.shoulderAngle(k, kin.elbowPosition(k, kin.wristPosition(k, ee)));
+      EXPECT_NEAR(angles[k], stages, 1e-3);
+    }
+  }
+}
+
+TEST(DeltaSolver, configuredGeometryReachesGlobalRobot)
+{
+  DeltaGeometry g = robot_geometry();
+  g.elbow_to_wrist = 50.0f;
+  robot_set_geometry(g);
+  robot_tool_offset(0, 0, 0, -9.0f);
+  deltarobot_setup();
+
+  LongForearmSolver fixed(DeltaStaticGeometry<LongForearmSpec>(), Vector3(0, 0, -9.0f));
+  float angles[NUM_AXIES];
+  ASSERT_TRUE(fixed.solve(Vector3(4, -3, 8), angles));
+  robot_position(4, -3, 8);
+  for (int k = 0; k < NUM_AXIES; ++k) {
+    EXPECT_NEAR(robot.arms[k].angle, angles[k], 1e-3);
+  }
+
+  // put the global robot back for the other tests
+  robot_set_geometry(DeltaStaticGeometry<UprootArmSpec>::measurements());
+  deltarobot_setup();
+}
@@ -0,0 +1,181 @@
+#include "deltaRobot.h"
+#include "deltaTrajectory.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+static const DeltaJointLimits trapezoid = {120.0f, 60.0f, 0.0f};
+static const DeltaJointLimits scurve = {120.0f, 600.0f, 3000.0f};
+
+// Worst joint speed between consecutive waypoints
+static float maxJointRate(const DeltaTrajectory& traj)
+{
+  const std::vector<DeltaWaypoint>& w = traj.waypoints();
+  float rate = 0;
+  for (size_t i = 1; i < w.size(); ++i) {
+    float dt = w[i].t - w[i - 1].t;
+    if (dt <= 0) continue;
+    for (int a = 0; a < NUM_AXIES; ++a) {
+      rate = std::max(rate, (float)fabs(w[i].angles[a] - w[i - 1].angles[a]) / dt);
+    }
+  }
+  return rate;
+}
+
+TEST(DeltaMotionProfile, trapezoidMatchesClosedForm)
+{
+  DeltaMotionProfile p;
+
+  // long enough to cruise: t = d/v + v/a
+  ASSERT_TRUE(p.plan(360.0f, 120.0f, 60.0f));
+  EXPECT_NEAR(p.duration(), 360.0f / 120.0f + 120.0f / 60.0f, 1e-4);
+  EXPECT_NEAR(p.peakVelocity(), 120.0f, 1e-4);
+
+  // too short to cruise: t = 2 sqrt(d/a)
+  ASSERT_TRUE(p.plan(30.0f, 120.0f, 60.0f));
+  EXPECT_NEAR(p.duration(), 2 * sqrt(30.0f / 60.0f), 1e-3);
+  EXPECT_NEAR(p.position(p.duration()), 30.0f, 1e-3);
+}
+
+TEST(DeltaMotionProfile, scurveRespectsLimits)
+{
+  const float distances[] = {0.5f, 5.0f, 40.0f, 200.0f};
+  for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); ++d) {
+    DeltaMotionProfile p;
+    ASSERT_TRUE(p.plan(distances[d], 120.0f, 600.0f, 3000.0f));
+    EXPECT_NEAR(p.position(p.duration()), distances[d], 1e-3 * distances[d]);
+
+    float last = 0;
+    for (int i = 0; i <= 1000; ++i) {
+      float t = p.duration() * i / 1000;
+      float s, v, a;
+      p.sample(t, s, v, a);
+      EXPECT_GE(s, last - 1e-4f);
+      EXPECT_LE(v, 120.0f * 1.001f);
+      EXPECT_LE(fabs(a), 600.0f * 1.001f);
+      EXPECT_NEAR(p.position(p.timeAt(s)), s, 1e-4f * distances[d]);
+      last = s;
+    }
+
+    // limiting jerk can only slow it down
+    DeltaMotionProfile q;
+    q.plan(distances[d], 120.0f, 600.0f);
+    EXPECT_GE(p.duration(), q.duration());
+  }
+}
+
+TEST(DeltaMotionProfile, rejectsBadLimits)
+{
+  DeltaMotionProfile p;
+  EXPECT_FALSE(p.plan(10.0f, 0.0f, 60.0f));
+  EXPECT_FALSE(p.plan(10.0f, 120.0f, 0.0f));
+  EXPECT_FALSE(p.plan(-1.0f, 120.0f, 60.0f));
+  ASSERT_TRUE(p.plan(0.0f, 120.0f, 60.0f));
+  EXPECT_EQ(p.duration(), 0.0f);
+}
+
+TEST(DeltaTrajectory, lineFollowsIk)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  Vector3 start(-10, 5, 6), end(12, -8, 10);
+
+  DeltaTrajectory traj;
+  ASSERT_TRUE(traj.line(kin, start, end, scurve));
+  ASSERT_TRUE(traj.valid());
+
+  // ends on the IK solutions
+  float expected[NUM_AXIES], angles[NUM_AXIES];
+  ASSERT_TRUE(kin.solve(start, expected));
+  traj.sample(0, angles);
+  for (int a = 0; a < NUM_AXIES; ++a) EXPECT_NEAR(angles[a], expected[a], 1e-4);
+  ASSERT_TRUE(kin.solve(end, expected));
+  traj.sample(traj.duration(), angles);
+  for (int a = 0; a < NUM_AXIES; ++a) EXPECT_NEAR(angles[a], expected[a], 1e-4);
+
+  // the tool stays on the line in between
+  for (int i = 1; i < 10; ++i) {
+    Vector3 p;
+    traj.sample(traj.duration() * i / 10, angles);
+    ASSERT_TRUE(kin.forward(angles, p));
+    Vector3 d = end - start;
+    float along = ((p - start) | d) / d.LengthSquared();
+    EXPECT_LT((p - (start + d * along)).Length(), 0.05f);
+  }
+
+  EXPECT_LE(maxJointRate(traj), scurve.velocity * 1.01f);
+}
+
+TEST(DeltaTrajectory, unreachableLineFails)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaTrajectory traj;
+  EXPECT_FALSE(traj.line(kin, Vector3(0, 0, 6), Vector3(0, 0, -200), trapezoid));
+  EXPECT_FALSE(traj.valid());
+}
+
+TEST(DeltaTrajectory, blendCutsCorners)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  std::vector<Vector3> points;
+  points.push_back(Vector3(-10, -10, 6));
+  points.push_back(Vector3(10, -10, 6));
+  points.push_back(Vector3(10, 10, 6));
+
+  DeltaTrajectory sharp, blended;
+  ASSERT_TRUE(sharp.path(kin, points, 0, scurve));
+  ASSERT_TRUE(blended.path(kin, points, 3.0f, scurve));
+
+  // the blend misses the corner by r/2 along the diagonal, r/sqrt(8)
+  float closest = 1e9f;
+  for (size_t i = 0; i < blended.waypoints().size(); ++i) {
+    Vector3 p;
+    ASSERT_TRUE(kin.forward(blended.waypoints()[i].angles, p));
+    closest = std::min(closest, (p - points[1]).Length());
+  }
+  EXPECT_NEAR(closest, 3.0f / sqrt(8.0f), 0.05f);
+
+  EXPECT_LE(maxJointRate(blended), scurve.velocity * 1.01f);
+}
+
+TEST(DeltaTrajectory, jointMoveArrivesTogether)
+{
+  float start[NUM_AXIES] = {0, 10, 20};
+  float end[NUM_AXIES] = {60, 10, 50};
+
+  DeltaTrajectory traj;
+  ASSERT_TRUE(traj.joint(start, end, trapezoid));
+
+  // the 60 degree joint sets the time: 2 sqrt(60/60) since it can't reach 120 deg/s
+  EXPECT_NEAR(traj.duration(), 2.0f, 1e-3);
+
+  float angles[NUM_AXIES];
+  traj.sample(traj.duration() / 2, angles);
+  EXPECT_NEAR(angles[0], 30.0f, 0.1f);
+  EXPECT_NEAR(angles[1], 10.0f, 1e-4);
+  EXPECT_NEAR(angles[2], 35.0f, 0.1f);
+}
+
+TEST(DeltaTrajectory, compactKeepsShape)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  DeltaTrajectory traj;
+  ASSERT_TRUE(traj.line(kin, Vector3(-15, 0, 5), Vector3(15, 5, 12), scurve));
+
+  DeltaTrajectory full = traj;
+  traj.compact(0.05f);
+  EXPECT_LT(traj.waypoints().size(), full.waypoints().size() / 4);
+  EXPECT_EQ(traj.duration(), full.duration());
+
+  for (int i = 0; i <= 200; ++i) {
+    float t = full.duration() * i / 200;
+    float a[NUM_AXIES], b[NUM_AXIES];
+    full.sample(t, a);
+    traj.sample(t, b);
+    for (int k = 0; k < NUM_AXIES; ++k) EXPECT_NEAR(a[k], b[k], 0.06f);
+  }
+}
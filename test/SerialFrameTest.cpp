@@ -0,0 +1,143 @@
+#include "serialFrame.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <random>
+#include <string.h>
+#include <vector>
+
+// Something the size of a CmdMsg
+struct TestMsg {
+  uint32_t type;
+  uint32_t angles[3];
+  uint32_t success;
+};
+
+static TestMsg testMsg(uint32_t i)
+{
+  // sync bytes and newlines in the payload on purpose
+  TestMsg m = {i, {0xA5A5A5A5u, 0x0A0A0A0Au, i * 7919u}, i & 1};
+  return m;
+}
+
+static void appendFrame(std::vector<uint8_t>& stream, uint8_t sequence, const TestMsg& m)
+{
+  uint8_t buf[SERIAL_FRAME_MAX_SIZE];
+  size_t size = serial_frame_encode(sequence, &m, sizeof(m), buf);
+  ASSERT_EQ(size, sizeof(m) + SERIAL_FRAME_OVERHEAD);
+  stream.insert(stream.end(), buf, buf + size);
+}
+
+// Everything decoded from the stream, fed chunk bytes at a time
+static std::vector<TestMsg> decodeAll(const std::vector<uint8_t>& stream, size_t chunk,
+                                      std::vector<uint8_t>* sequences = NULL)
+{
+  SerialFrameDecoder decoder;
+  std::vector<TestMsg> out;
+  for (size_t start = 0; start < stream.size(); start += chunk) {
+    size_t n = std::min(chunk, stream.size() - start);
+    size_t used = 0;
+    while (used < n) {
+      SerialFrame frame;
+      bool complete;
+      used += decoder.decode(&stream[start + used], n - used, frame, complete);
+      if (!complete) continue;
+      EXPECT_EQ(frame.length, sizeof(TestMsg));
+      TestMsg m;
+      memcpy(&m, frame.payload, sizeof(m));
+      out.push_back(m);
+      if (sequences) sequences->push_back(frame.sequence);
+    }
+  }
+  return out;
+}
+
+TEST(SerialFrame, crcCheckValue)
+{
+  const char* check = "123456789";
+  EXPECT_EQ(serial_crc16((const uint8_t*)check, 9), 0x29B1);
+}
+
+TEST(SerialFrame, tooLongToFrame)
+{
+  uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD + 1] = {0};
+  uint8_t buf[SERIAL_FRAME_MAX_SIZE + 1];
+  EXPECT_EQ(serial_frame_encode(0, payload, sizeof(payload), buf), 0u);
+}
+
+TEST(SerialFrame, roundTripInAnyChunks)
+{
+  std::vector<uint8_t> stream;
+  for (uint32_t i = 0; i < 50; ++i) appendFrame(stream, (uint8_t)i, testMsg(i));
+
+  const size_t chunks[] = {1, 2, 7, 41, 64, 4096};
+  for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c) {
+    std::vector<uint8_t> sequences;
+    std::vector<TestMsg> out = decodeAll(stream, chunks[c], &sequences);
+    ASSERT_EQ(out.size(), 50u) << "chunk " << chunks[c];
+    for (uint32_t i = 0; i < 50; ++i) {
+      TestMsg expected = testMsg(i);
+      EXPECT_EQ(memcmp(&out[i], &expected, sizeof(TestMsg)), 0);
+      EXPECT_EQ(sequences[i], i);
+    }
+  }
+}
+
+TEST(SerialFrame, resyncsAfterGarbageAndTruncation)
+{
+  std::vector<uint8_t> stream;
+  appendFrame(stream, 0, testMsg(0));
+  // line noise, with a sync byte and a length that could be a frame
+  const uint8_t noise[] = {0x00, 0xA5, 0x10, 0xFF, 0xA5, 0xA5, 0x0A};
+  stream.insert(stream.end(), noise, noise + sizeof(noise));
+  appendFrame(stream, 1, testMsg(1));
+  // a frame cut short
+  std::vector<uint8_t> cut;
+  appendFrame(cut, 2, testMsg(2));
+  stream.insert(stream.end(), cut.begin(), cut.begin() + cut.size() / 2);
+  appendFrame(stream, 3, testMsg(3));
+
+  for (size_t chunk = 1; chunk <= stream.size(); chunk *= 3) {
+    std::vector<uint8_t> sequences;
+    decodeAll(stream, chunk, &sequences);
+    ASSERT_EQ(sequences.size(), 3u) << "chunk " << chunk;
+    EXPECT_EQ(sequences[0], 0);
+    EXPECT_EQ(sequences[1], 1);
+    EXPECT_EQ(sequences[2], 3);
+  }
+}
+
+TEST(SerialFrame, corruptedFramesAreDroppedTheRestKept)
+{
+  std::mt19937 rng(7);
+  std::vector<uint8_t> stream;
+  std::vector<bool> corrupted;
+  for (uint32_t i = 0; i < 2000; ++i) {
+    std::vector<uint8_t> frame;
+    appendFrame(frame, (uint8_t)i, testMsg(i));
+    bool corrupt = rng() % 10 == 0;
+    if (corrupt) {
+      // flip a byte, drop one or add one (inside it, a byte ahead of it is just noise)
+      size_t at = 1 + rng() % (frame.size() - 1);
+      switch (rng() % 3) {
+      case 0: frame[at] ^= (uint8_t)(1 + rng() % 255); break;
+      case 1: frame.erase(frame.begin() + at); break;
+      case 2: frame.insert(frame.begin() + at, (uint8_t)rng()); break;
+      }
+    }
+    corrupted.push_back(corrupt);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+
+  std::vector<TestMsg> out = decodeAll(stream, 61);
+  size_t k = 0;
+  for (uint32_t i = 0; i < corrupted.size(); ++i) {
+    if (corrupted[i]) continue;
+    ASSERT_LT(k, out.size());
+    EXPECT_EQ(out[k].type, i);
+    k++;
+  }
+  EXPECT_EQ(k, out.size());
+}
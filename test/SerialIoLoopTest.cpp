@@ -0,0 +1,142 @@
+#include "serialIoLoop.h"
+#include "serialFrame.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <chrono>
+#include <condition_variable>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// A pseudo terminal stands in for the Teensy: the loop gets the tty end, the
+// test reads and writes the other
+class PtyLink : public ::testing::Test
+{
+protected:
+  PtyLink() : master(-1), port(-1) {}
+
+  void SetUp()
+  {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(grantpt(master), 0);
+    ASSERT_EQ(unlockpt(master), 0);
+    port = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    ASSERT_GE(port, 0);
+
+    termios tio;
+    ASSERT_EQ(tcgetattr(port, &tio), 0);
+    cfmakeraw(&tio);
+    ASSERT_EQ(tcsetattr(port, TCSANOW, &tio), 0);
+  }
+
+  void TearDown()
+  {
+    if (port >= 0) close(port);
+    if (master >= 0) close(master);
+  }
+
+  // Read n bytes off the far end, giving up after a second
+  std::vector<uint8_t> readFar(size_t n)
+  {
+    std::vector<uint8_t> got;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (got.size() < n && std::chrono::steady_clock::now() < end) {
+      uint8_t buf[256];
+      ssize_t r = read(master, buf, std::min(sizeof(buf), n - got.size()));
+      if (r > 0) got.insert(got.end(), buf, buf + r);
+    }
+    return got;
+  }
+
+  int master, port;
+};
+
+// A frame whose one byte of payload is its tag
+static std::vector<uint8_t> taggedFrame(uint8_t tag)
+{
+  uint8_t buf[SERIAL_FRAME_MAX_SIZE];
+  size_t size = serial_frame_encode(tag, &tag, 1, buf);
+  return std::vector<uint8_t>(buf, buf + size);
+}
+
+TEST_F(PtyLink, writesQueuedFramesInOrder)
+{
+  SerialIoLoop loop(port, 115200, 16, SerialIoLoop::ReadHandler([](const uint8_t *, size_t) {}));
+  ASSERT_TRUE(loop.ok());
+  std::thread io([&loop]() { EXPECT_TRUE(loop.run()); });
+
+  std::vector<uint8_t> expected;
+  for (uint8_t i = 0; i < 10; ++i) {
+    std::vector<uint8_t> frame = taggedFrame(i);
+    EXPECT_TRUE(loop.send(frame.data(), frame.size(), false));
+    expected.insert(expected.end(), frame.begin(), frame.end());
+  }
+
+  EXPECT_EQ(readFar(expected.size()), expected);
+  loop.stop();
+  io.join();
+  EXPECT_EQ(loop.sent(), 10u);
+}
+
+TEST_F(PtyLink, onlyTheLatestWaitingTargetGoesOut)
+{
+  SerialIoLoop loop(port, 115200, 16, SerialIoLoop::ReadHandler([](const uint8_t *, size_t) {}));
+  ASSERT_TRUE(loop.ok());
+
+  // all waiting before the loop starts writing
+  std::vector<uint8_t> config = taggedFrame(1);
+  loop.send(config.data(), config.size(), false);
+  for (uint8_t i = 10; i < 14; ++i) {
+    std::vector<uint8_t> target = taggedFrame(i);
+    loop.send(target.data(), target.size(), true);
+  }
+  std::thread io([&loop]() { EXPECT_TRUE(loop.run()); });
+
+  std::vector<uint8_t> expected = config;
+  std::vector<uint8_t> latest = taggedFrame(13);
+  expected.insert(expected.end(), latest.begin(), latest.end());
+  EXPECT_EQ(readFar(expected.size()), expected);
+
+  loop.stop();
+  io.join();
+  EXPECT_EQ(loop.sent(), 2u);
+  EXPECT_EQ(loop.coalesced(), 3u);
+}
+
+TEST_F(PtyLink, handsOnWhatComesIn)
+{
+  std::mutex mutex;
+  std::condition_variable arrived;
+  std::vector<uint8_t> got;
+  SerialIoLoop loop(port, 115200, 16, [&](const uint8_t *data, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    got.insert(got.end(), data, data + n);
+    arrived.notify_all();
+  });
+  ASSERT_TRUE(loop.ok());
+  std::thread io([&loop]() { EXPECT_TRUE(loop.run()); });
+
+  std::vector<uint8_t> sent;
+  for (int i = 0; i < 2000; ++i) sent.push_back((uint8_t)(i * 31));
+  ASSERT_EQ(write(master, sent.data(), sent.size()), (ssize_t)sent.size());
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    arrived.wait_for(lock, std::chrono::seconds(1), [&]() { return got.size() >= sent.size(); });
+    EXPECT_EQ(got, sent);
+  }
+  loop.stop();
+  io.join();
+}
+
+TEST(SerialPort, unknownBaudRate)
+{
+  EXPECT_LT(serial_port_open("/dev/null", 12345), 0);
+}
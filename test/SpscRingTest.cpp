@@ -0,0 +1,64 @@
+#include "spscRing.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <thread>
+
+TEST(SpscRing, firstInFirstOut)
+{
+  SpscRing<int, 4> ring;
+  int item;
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.pop(item));
+
+  for (int i = 0; i < 4; ++i) EXPECT_TRUE(ring.push(i));
+  EXPECT_FALSE(ring.push(4));
+  EXPECT_EQ(ring.size(), 4u);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, i);
+  }
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, wrapsAround)
+{
+  SpscRing<int, 4> ring;
+  int item;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(ring.push(i));
+    ASSERT_TRUE(ring.push(-i));
+    ASSERT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, i);
+    ASSERT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, -i);
+  }
+}
+
+TEST(SpscRing, nothingLostAcrossThreads)
+{
+  const int count = 200000;
+  SpscRing<int, 64> ring;
+
+  std::thread producer([&ring]() {
+    for (int i = 0; i < count; ++i) {
+      while (!ring.push(i)) std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  while (expected < count) {
+    int item;
+    if (!ring.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(item, expected);
+    expected++;
+  }
+  producer.join();
+  EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,70 @@
+#include "vector3.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <math.h>
+#include <string.h>
+
+TEST(Vector3, matchesComponentMath)
+{
+  Vector3 a(1.5f, -2.0f, 3.25f);
+  Vector3 b(-0.5f, 4.0f, 2.0f);
+
+  Vector3 c = a ^ b;
+  EXPECT_FLOAT_EQ(c.x, a.y * b.z - a.z * b.y);
+  EXPECT_FLOAT_EQ(c.y, a.z * b.x - a.x * b.z);
+  EXPECT_FLOAT_EQ(c.z, a.x * b.y - a.y * b.x);
+
+  EXPECT_FLOAT_EQ(a | b, a.x * b.x + a.y * b.y + a.z * b.z);
+  EXPECT_FLOAT_EQ(a.Length(), sqrtf(a.x * a.x + a.y * a.y + a.z * a.z));
+
+  Vector3 d = (a + b) * 2.0f - b / 4.0f;
+  EXPECT_FLOAT_EQ(d.x, (a.x + b.x) * 2.0f - b.x / 4.0f);
+  EXPECT_FLOAT_EQ(d.y, (a.y + b.y) * 2.0f - b.y / 4.0f);
+  EXPECT_FLOAT_EQ(d.z, (a.z + b.z) * 2.0f - b.z / 4.0f);
+
+  d = -a;
+  d += b;
+  d *= b;
+  EXPECT_FLOAT_EQ(d.x, (b.x - a.x) * b.x);
+  EXPECT_FLOAT_EQ(d.y, (b.y - a.y) * b.y);
+  EXPECT_FLOAT_EQ(d.z, (b.z - a.z) * b.z);
+}
+
+TEST(Vector3, padLaneStaysZero)
+{
+  Vector3 a(1, 2, 3);
+  Vector3 b(4, 5, 6);
+  Vector3 r[] = {a + b, a - b, a * b, a ^ b, a * 3.0f, a / 0.0f, -a};
+  for (size_t i = 0; i < sizeof(r) / sizeof(r[0]); ++i) {
+    EXPECT_EQ(r[i].w, 0.0f) << i;
+  }
+}
+
+TEST(Vector3, normalize)
+{
+  Vector3 a(3, 0, 4);
+  EXPECT_FLOAT_EQ(a.NormalizeLength(), 5.0f);
+  EXPECT_FLOAT_EQ(a.x, 0.6f);
+  EXPECT_FLOAT_EQ(a.z, 0.8f);
+
+  // a zero vector stays zero rather than going NaN
+  Vector3 z;
+  z.Normalize();
+  EXPECT_EQ(z.x, 0.0f);
+  EXPECT_EQ(z.y, 0.0f);
+  EXPECT_EQ(z.z, 0.0f);
+}
+
+TEST(Vector3, triviallyCopyable)
+{
+  constexpr Vector3 c(1, 2, 3);
+  static_assert(c.y == 2, "constexpr construction");
+
+  Vector3 src[2] = {Vector3(1, 2, 3), Vector3(4, 5, 6)};
+  Vector3 dst[2];
+  memcpy(dst, src, sizeof(src));
+  EXPECT_EQ(dst[1].y, 5.0f);
+}
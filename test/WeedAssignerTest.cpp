@@ -0,0 +1,128 @@
+#include "deltaRobot.h"
+#include "weedAssigner.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <math.h>
+#include <vector>
+
+static WeedSchedulerConfig testConfig()
+{
+  WeedSchedulerConfig c;
+  c.limits.velocity = 300;
+  c.limits.accel = 1500;
+  c.limits.jerk = 0;
+  c.dwell = 0.75f;
+  c.soil_offset = 3;
+  c.min_angle = 0;
+  c.max_angle = 90;
+  c.x_min = -32;
+  c.x_max = 32;
+  c.y_min = -40;
+  c.y_max = 25;
+  c.window = 8;
+  c.horizon = 4;
+  return c;
+}
+
+static WeedCandidate weed(int id, float x, float y, float vy = -10)
+{
+  WeedCandidate w = {id, Vector3(x, y, 0), Vector3(0, vy, 0)};
+  return w;
+}
+
+static ArmSlot idleArm(float mountX)
+{
+  ArmSlot s = {Vector3(mountX, 0, 0), {0, 0, 0}, 0, -1, Vector3()};
+  return s;
+}
+
+// Two arms side by side across the bed, workspaces overlapping in the middle
+class TwoArms : public ::testing::Test
+{
+protected:
+  TwoArms()
+    : kin0(robot_geometry(), Vector3(0, 0, -9.0f)), kin1(robot_geometry(), Vector3(0, 0, -9.0f)),
+      arm0(kin0, testConfig()), arm1(kin1, testConfig())
+  {
+    arms.push_back(&arm0);
+    arms.push_back(&arm1);
+    slots.push_back(idleArm(-25));
+    slots.push_back(idleArm(25));
+  }
+
+  DeltaKinematics kin0, kin1;
+  WeedScheduler arm0, arm1;
+  std::vector<const WeedScheduler*> arms;
+  std::vector<ArmSlot> slots;
+};
+
+TEST_F(TwoArms, eachTakesItsOwnSide)
+{
+  WeedAssigner assigner(arms, 20);
+  std::vector<WeedCandidate> weeds;
+  weeds.push_back(weed(1, -40, 0));
+  weeds.push_back(weed(2, 40, 0));
+
+  std::vector<int> assigned = assigner.assign(slots, weeds);
+  EXPECT_EQ(assigned[0], 0);
+  EXPECT_EQ(assigned[1], 1);
+}
+
+TEST_F(TwoArms, busyArmLeavesTheMiddleToTheOther)
+{
+  WeedAssigner assigner(arms, 20);
+  // arm 0 is a while yet on a weed at the far side of it
+  slots[0].free = 1.5f;
+  slots[0].held = 7;
+  slots[0].held_position = Vector3(-50, 0, 0);
+
+  std::vector<WeedCandidate> weeds;
+  weeds.push_back(weed(7, -50, 0));
+  weeds.push_back(weed(1, 0, 0));
+
+  std::vector<int> assigned = assigner.assign(slots, weeds);
+  EXPECT_EQ(assigned[0], 0);
+  EXPECT_EQ(assigned[1], 1);
+  EXPECT_EQ(assigner.order(0).size(), 0u);
+}
+
+TEST_F(TwoArms, neverWithinClearance)
+{
+  const float clearance = 20;
+  WeedAssigner assigner(arms, clearance);
+
+  // a dense stretch across the overlap
+  std::vector<WeedCandidate> weeds;
+  for (int i = 0; i < 12; ++i) {
+    weeds.push_back(weed(i, -30.0f + 6.0f * i, -20.0f + 3.0f * (i % 4)));
+  }
+
+  std::vector<int> assigned = assigner.assign(slots, weeds);
+  int given = 0;
+  for (size_t i = 0; i < weeds.size(); ++i) {
+    if (assigned[i] < 0) continue;
+    given++;
+    for (size_t j = 0; j < weeds.size(); ++j) {
+      if (assigned[j] < 0 || assigned[j] == assigned[i]) continue;
+      Vector3 d = weeds[i].position - weeds[j].position;
+      EXPECT_GE(d.Length(), clearance);
+    }
+  }
+  EXPECT_EQ(given, (int)(assigner.order(0).size() + assigner.order(1).size()));
+  EXPECT_GT(assigner.order(0).size(), 0u);
+  EXPECT_GT(assigner.order(1).size(), 0u);
+}
+
+TEST_F(TwoArms, heldWeedStaysPut)
+{
+  WeedAssigner assigner(arms, 20);
+  // arm 1 took this one while it was on its side
+  slots[1].held = 3;
+  slots[1].held_position = Vector3(-10, 0, 0);
+
+  std::vector<WeedCandidate> weeds(1, weed(3, -10, 0));
+  EXPECT_EQ(assigner.assign(slots, weeds)[0], 1);
+}
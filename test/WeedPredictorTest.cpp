@@ -0,0 +1,114 @@
+#include "weedPredictor.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <math.h>
+#include <stdlib.h>
+
+static float noise(float sd)
+{
+  // roughly gaussian, sum of uniforms
+  float s = 0;
+  for (int i = 0; i < 12; ++i) s += (float)rand() / RAND_MAX;
+  return (s - 6.0f) * sd;
+}
+
+TEST(WeedPredictor, firstPositionHoldsStill)
+{
+  WeedPredictor p;
+  EXPECT_FALSE(p.valid());
+
+  p.updatePosition(1.0, Vector3(4, 10, 2));
+  ASSERT_TRUE(p.valid());
+  Vector3 q = p.predict(2.0);
+  EXPECT_FLOAT_EQ(q.x, 4);
+  EXPECT_FLOAT_EQ(q.y, 10);
+  EXPECT_FLOAT_EQ(q.z, 2);
+}
+
+TEST(WeedPredictor, learnsVelocityFromPositions)
+{
+  WeedPredictor p;
+  srand(5);
+  // 30 fps, moving at -20 cm/s along y
+  for (int i = 0; i < 30; ++i) {
+    double t = i / 30.0;
+    p.updatePosition(t, Vector3(3 + noise(0.3f), 20 - 20 * (float)t + noise(0.3f), 1));
+  }
+  EXPECT_NEAR(p.velocity().y, -20, 2);
+  EXPECT_NEAR(p.velocity().x, 0, 2);
+
+  // half a second of travel after the last frame
+  Vector3 q = p.predict(29 / 30.0 + 0.5);
+  EXPECT_NEAR(q.y, 20 - 20 * (29 / 30.0 + 0.5), 1.0);
+  EXPECT_NEAR(q.x, 3, 1.0);
+}
+
+TEST(WeedPredictor, velocityTopicSpeedsItUp)
+{
+  WeedPredictor withTopic, without;
+  for (int i = 0; i < 3; ++i) {
+    double t = i / 30.0;
+    Vector3 pos(0, 20 - 20 * (float)t, 1);
+    withTopic.updatePosition(t, pos);
+    withTopic.updateVelocity(t, -20);
+    without.updatePosition(t, pos);
+  }
+  EXPECT_LT(fabs(withTopic.velocity().y + 20), fabs(without.velocity().y + 20));
+  EXPECT_NEAR(withTopic.velocity().y, -20, 1);
+}
+
+TEST(WeedPredictor, sameFrameCountsOnce)
+{
+  WeedPredictor once, twice;
+  once.updatePosition(0, Vector3(0, 0, 0));
+  twice.updatePosition(0, Vector3(0, 0, 0));
+  once.updatePosition(0.1, Vector3(0, -2, 0));
+  twice.updatePosition(0.1, Vector3(0, -2, 0));
+  twice.updatePosition(0.1, Vector3(0, -2, 0));
+  // and older ones don't count at all
+  twice.updatePosition(0.05, Vector3(0, 5, 0));
+
+  EXPECT_FLOAT_EQ(once.predict(1).y, twice.predict(1).y);
+  EXPECT_DOUBLE_EQ(twice.time(), 0.1);
+}
+
+TEST(WeedPredictor, sameVelocityReadingCountsOnce)
+{
+  WeedPredictor once, repeated;
+  once.updatePosition(0, Vector3(0, 20, 1));
+  repeated.updatePosition(0, Vector3(0, 20, 1));
+  once.updateVelocity(0, -20);
+  repeated.updateVelocity(0, -20);
+
+  // the governor passes the latest reading on with every position
+  for (int i = 0; i < 10; ++i) repeated.updateVelocity(0, -20);
+  EXPECT_FLOAT_EQ(once.velocityVariance(), repeated.velocityVariance());
+  EXPECT_FLOAT_EQ(once.velocity().y, repeated.velocity().y);
+
+  // a new reading still counts
+  repeated.updateVelocity(0.1, -20);
+  EXPECT_LT(repeated.velocityVariance(), once.velocityVariance());
+}
+
+TEST(WeedPredictor, velocityStampedAheadOfThePositions)
+{
+  // readings stamped when they arrive, well after the frames that follow
+  // them were captured
+  WeedPredictor p;
+  for (int i = 0; i < 30; ++i) {
+    double t = i / 30.0;
+    p.updatePosition(t, Vector3(5 * (float)t, 20 - 20 * (float)t, 1));
+    p.updateVelocity(t + 0.25, -20);
+  }
+
+  double last = 29 / 30.0;
+  EXPECT_DOUBLE_EQ(p.time(), last);
+  Vector3 q = p.predict(last);
+  EXPECT_NEAR(q.x, 5 * last, 0.2);
+  EXPECT_NEAR(q.y, 20 - 20 * last, 0.2);
+  EXPECT_NEAR(p.velocity().x, 5, 1);
+  EXPECT_NEAR(p.velocity().y, -20, 1);
+}
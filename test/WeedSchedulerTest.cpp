@@ -0,0 +1,133 @@
+#include "deltaRobot.h"
+#include "weedScheduler.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+// STD
+#include <vector>
+
+static WeedSchedulerConfig testConfig()
+{
+  WeedSchedulerConfig c;
+  c.limits.velocity = 300;
+  c.limits.accel = 1500;
+  c.limits.jerk = 0;
+  c.dwell = 0.75f;
+  c.soil_offset = 3;
+  c.min_angle = 0;
+  c.max_angle = 90;
+  c.x_min = -32;
+  c.x_max = 32;
+  c.y_min = -40;
+  c.y_max = 25;
+  c.window = 8;
+  c.horizon = 4;
+  return c;
+}
+
+static WeedCandidate weed(int id, float x, float y, float vy = -10)
+{
+  WeedCandidate w = {id, Vector3(x, y, 0), Vector3(0, vy, 0)};
+  return w;
+}
+
+// Weeds done in the given order, each from where the last one left the arm
+static int finished(const WeedScheduler& s, const float start[NUM_AXIES],
+                    const std::vector<WeedCandidate>& weeds, const std::vector<int>& order)
+{
+  float from[NUM_AXIES] = {start[0], start[1], start[2]};
+  float t = 0;
+  int n = 0;
+  for (size_t k = 0; k < order.size(); ++k) {
+    for (size_t i = 0; i < weeds.size(); ++i) {
+      float angles[NUM_AXIES], done;
+      if (weeds[i].id != order[k] || !s.visit(weeds[i], from, t, angles, done)) continue;
+      std::copy(angles, angles + NUM_AXIES, from);
+      t = done;
+      n++;
+    }
+  }
+  return n;
+}
+
+TEST(WeedScheduler, dropsWeedsThatLeaveFirst)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  WeedScheduler s(kin, testConfig());
+  float rest[NUM_AXIES] = {0, 0, 0};
+
+  // gone before the dwell is over
+  std::vector<WeedCandidate> weeds(1, weed(1, 0, -38));
+  EXPECT_TRUE(s.plan(rest, weeds).empty());
+}
+
+TEST(WeedScheduler, waitsForWeedsComingIn)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  WeedScheduler s(kin, testConfig());
+  float rest[NUM_AXIES] = {0, 0, 0};
+
+  // enters the workspace in half a second
+  std::vector<WeedCandidate> weeds(1, weed(1, 0, 30));
+  ASSERT_EQ(s.plan(rest, weeds).size(), 1u);
+  EXPECT_GE(s.finish(), 0.5f + testConfig().dwell);
+}
+
+TEST(WeedScheduler, beatsTheTrackersOrder)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  WeedScheduler s(kin, testConfig());
+  float rest[NUM_AXIES] = {0, 0, 0};
+
+  // a dense stretch, zig-zagging across the bed
+  std::vector<WeedCandidate> weeds;
+  std::vector<int> trackerOrder;
+  for (int i = 0; i < 8; ++i) {
+    weeds.push_back(weed(i, (i % 2) ? 20.0f : -20.0f, -30.0f + 6.0f * i, -8));
+    trackerOrder.push_back(i);
+  }
+
+  std::vector<int> order = s.plan(rest, weeds);
+  int planned = finished(s, rest, weeds, order);
+  EXPECT_EQ(planned, (int)order.size());
+  EXPECT_GE(planned, finished(s, rest, weeds, std::vector<int>(trackerOrder.begin(), trackerOrder.begin() + 4)));
+  EXPECT_GT(planned, 0);
+}
+
+TEST(WeedScheduler, replanStartsFromLastPlan)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  WeedScheduler s(kin, testConfig());
+  float rest[NUM_AXIES] = {0, 0, 0};
+
+  std::vector<WeedCandidate> weeds;
+  for (int i = 0; i < 8; ++i) {
+    weeds.push_back(weed(i, -25.0f + 7.0f * i, -25.0f + 5.0f * (i % 3)));
+  }
+
+  std::vector<int> first = s.plan(rest, weeds);
+  int fromScratch = s.expanded();
+  std::vector<int> second = s.plan(rest, weeds);
+  EXPECT_EQ(first, second);
+  EXPECT_LE(s.expanded(), fromScratch);
+}
+
+TEST(WeedScheduler, plansWeedsOnlyReachableLater)
+{
+  DeltaKinematics kin(robot_geometry(), Vector3(0, 0, -9.0f));
+  WeedScheduler s(kin, testConfig());
+  float rest[NUM_AXIES] = {0, 0, 0};
+
+  // the second one drifts in from the side, too late to be first
+  std::vector<WeedCandidate> weeds(1, weed(1, 0, 0, -2));
+  WeedCandidate drifting = {2, Vector3(40, 0, 0), Vector3(-20, -2, 0)};
+  weeds.push_back(drifting);
+
+  float to[NUM_AXIES], done;
+  ASSERT_FALSE(s.visit(drifting, rest, 0, to, done));
+  std::vector<int> order = s.plan(rest, weeds);
+  ASSERT_EQ(order.size(), 2u);
+  EXPECT_EQ(order[0], 1);
+  EXPECT_EQ(order[1], 2);
+}